@@ -10,6 +10,9 @@ private:
     ApiClient& apiClient;
     SessionManager& sessionManager;
 
+    // Transactions requested per history page (server maximum)
+    static const int HISTORY_PAGE_SIZE = 1000;
+
 public:
     TransactionController(ApiClient& apiClient, SessionManager& sessionManager);
 
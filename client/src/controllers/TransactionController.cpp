@@ -3,6 +3,7 @@
 #include "ConsoleView.h"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 
 TransactionController::TransactionController(ApiClient& apiClient, SessionManager& sessionManager)
     : apiClient(apiClient), sessionManager(sessionManager) {
@@ -182,34 +183,44 @@ void TransactionController::showTransactionHistory() {
     }
     
     std::map<std::string, std::string> params = {
-        {"username", sessionManager.getCurrentUsername()}
+        {"username", sessionManager.getCurrentUsername()},
+        {"limit", std::to_string(HISTORY_PAGE_SIZE)}
     };
     
     ConsoleView::showMessage("Loading transaction history...");
     
-    json response;
-    bool success = apiClient.get("/api/transaction-history", params, response);
-    
-    if (!success) {
-        ConsoleView::showError("Failed to load transaction history: " + apiClient.getLastError());
-        return;
-    }
-    
-    if (response["status"] == "success") {
-        auto transactions = response["transactions"];
+    // The server returns the history in pages, newest first; follow next_cursor until the oldest page
+    std::vector<json> txList;
+    while (true) {
+        json response;
+        bool success = apiClient.get("/api/transaction-history", params, response);
         
-        if (transactions.empty()) {
-            ConsoleView::showMessage("No transactions found.");
+        if (!success) {
+            ConsoleView::showError("Failed to load transaction history: " + apiClient.getLastError());
             return;
         }
         
-        std::vector<json> txList;
-        for (const auto& tx : transactions) {
+        if (response["status"] != "success") {
+            ConsoleView::showError("Failed to load transaction history: " + response["message"].get<std::string>());
+            return;
+        }
+        
+        for (const auto& tx : response["transactions"]) {
             txList.push_back(tx);
         }
         
-        ConsoleView::showTransactions(txList);
-    } else {
-        ConsoleView::showError("Failed to load transaction history: " + response["message"].get<std::string>());
+        if (!response.contains("next_cursor") || !response["next_cursor"].is_string()) {
+            break;
+        }
+        params["cursor"] = response["next_cursor"].get<std::string>();
     }
+    
+    if (txList.empty()) {
+        ConsoleView::showMessage("No transactions found.");
+        return;
+    }
+    
+    // Show the history in chronological order, oldest first
+    std::reverse(txList.begin(), txList.end());
+    ConsoleView::showTransactions(txList);
 }
\ No newline at end of file
@@ -0,0 +1,77 @@
+// AccountCache.h - Sharded, size-bounded LRU cache of account records
+#ifndef ACCOUNT_CACHE_H
+#define ACCOUNT_CACHE_H
+
+#include <string>
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+#include "Common.h"
+
+class AccountCache {
+public:
+    // 分片数量（必须是2的幂）
+    static const size_t SHARD_COUNT = 16;
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        uint64_t invalidations;
+        size_t size;
+        size_t capacity;
+    };
+
+private:
+    // 每个分片一个LRU链表，表头为最近使用
+    struct Shard {
+        std::mutex mutex;
+        std::list<AccountRecord> lru;
+        std::unordered_map<std::string, std::list<AccountRecord>::iterator> index;
+        uint64_t generation;   // 每次失效递增，用于丢弃失效前读到的旧值
+
+        Shard() : generation(0) {}
+    };
+
+    Shard shards[SHARD_COUNT];
+    size_t capacity;        // 总容量，0表示禁用
+    size_t shardCapacity;
+
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> evictions;
+    std::atomic<uint64_t> invalidations;
+
+    Shard& shardFor(const std::string& username);
+    void putLocked(Shard& shard, const AccountRecord& account);
+
+public:
+    AccountCache(size_t capacity);
+
+    bool enabled() const { return capacity > 0; }
+
+    // 命中时复制到account并返回true
+    bool get(const std::string& username, AccountRecord& account);
+
+    // 只读取余额，命中时不分配内存
+    bool getBalance(const std::string& username, Money& balance);
+
+    // 写入后插入或更新（同时推进代数），超出分片容量时淘汰最久未使用的账户
+    void put(const AccountRecord& account);
+
+    // 读存储前取得代数；put时代数已变化说明期间发生过写入或失效，读到的值不再缓存
+    uint64_t generation(const std::string& username);
+    void put(const AccountRecord& account, uint64_t generation);
+
+    // 存储端增减余额后同步缓存中的余额（未缓存时只推进代数）
+    void updateBalance(const std::string& username, Money balance);
+
+    void invalidate(const std::string& username);
+    void clear();
+
+    Stats getStats();
+};
+
+#endif // ACCOUNT_CACHE_H
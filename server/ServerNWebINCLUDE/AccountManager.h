@@ -1,26 +1,72 @@
-// AccountManager.h - User account management with Redis storage
+// AccountManager.h - User account management on a pluggable storage backend
 #ifndef ACCOUNT_MANAGER_H
 #define ACCOUNT_MANAGER_H
 
 #include <string>
 #include <map>
 #include <mutex>
+#include <memory>
+#include <atomic>
 #include "Common.h"
-#include "RedisClient.h"
+#include "StorageBackend.h"
+#include "AccountTable.h"
+#include "AccountCache.h"
+#include "BloomFilter.h"
+#include "LockStripes.h"
+#include "AccountShards.h"
 
 class AccountManager {
 private:
-    RedisClient redis;
-    std::mutex users_mutex;
+    StorageBackend& storage;
+    AccountTable* table;   // 可选的内存映射账户表，启用后读取不再访问存储
+    AccountCache cache;    // 未启用账户表时缓存反序列化后的账户
+    LockStripes accountLocks;  // 按用户名分条带，保护单个账户的读-改-写
+    AccountShards* shards;     // 启用分片执行时账户修改投递到所属分片（为空表示使用条带锁）
+
+    // 用户名布隆过滤器，确定不存在的用户名无需访问存储（为空表示未启用）
+    std::shared_ptr<CountingBloomFilter> usernameFilter;
+    std::atomic<uint64_t> filterRejects;
+
+    static void fillUser(const AccountSlot& slot, User& user);
+    static void fillAccount(const AccountSlot& slot, AccountRecord& account);
+
+    // 账户哈希表读写（不经过缓存）
+    bool readAccount(const std::string& username, AccountRecord& account);
+    bool writeAccount(const AccountRecord& account);
+
+    // 先查缓存，未命中时从存储读取并写入缓存
+    bool loadAccount(const std::string& username, AccountRecord& account);
+
+    // 过滤器判定用户名一定不存在时返回false
+    bool mayExist(const std::string& username);
+
+    // 按用户列表重建过滤器
+    bool rebuildUsernameFilter(size_t expectedUsers);
+
+    // 处理其他进程写入引起的失效通知
+    void onInvalidation(const std::vector<std::string>& keys);
+
+    // 是否为账户哈希键"user:<用户名>"（同一前缀下的交易、存款等键不是）
+    static bool isAccountKey(const std::string& key);
 
 public:
-    AccountManager(const std::string& redis_host = "localhost",
-        int redis_port = 6379,
-        const std::string& redis_password = "");
+    AccountManager(StorageBackend& storage, size_t cacheCapacity = 0);
     ~AccountManager();
 
-    // Connect to Redis
-    bool connect();
+    // Use a memory-mapped account table for lookups (must be called before serving requests)
+    void setAccountTable(AccountTable* table);
+
+    // Subscribe to storage invalidations so the cache and username filter stay coherent across processes
+    bool enableCacheInvalidation();
+
+    // Build the username Bloom filter from the users list
+    bool enableUsernameFilter(size_t expectedUsers);
+
+    // Convert accounts stored as serialized strings into the hash layout (idempotent)
+    bool migrateAccountLayout();
+
+    // Rebuild the account table from storage (storage is authoritative)
+    bool loadAccountTable();
 
     // Register a new user
     bool registerUser(const std::string& username, const std::string& password, int account_type);
@@ -28,16 +74,48 @@ public:
     // Authenticate a user
     bool authenticateUser(const std::string& username, const std::string& password);
 
-    // Get user pointer by username (cached temporarily)
-    User* getUser(const std::string& username);
+    // Copy the account into a caller-owned record; returns false if the user does not exist
+    bool getAccount(const std::string& username, AccountRecord& account);
+
+    // Get balance without allocating on a table or cache hit; returns false if the user does not exist
+    bool getBalance(const std::string& username, Money& balance);
+
+    // Update account in storage; read-modify-write callers must hold the account's stripe lock
+    bool updateAccount(const AccountRecord& account);
+
+    // Add amount (negative to debit) to the balance; fails without change if the result would be
+    // negative. Without shards or an account table this is a single conditional increment in storage.
+    bool adjustBalance(const std::string& username, Money amount, Money& balance);
+
+    bool usesAccountTable() const { return table != nullptr; }
+
+    // Per-account lock stripes shared with the transaction and deposit managers
+    LockStripes& getAccountLocks() { return accountLocks; }
+
+    // Route account mutations to shard executors (nullptr restores stripe locking)
+    void setShards(AccountShards* shards);
+    AccountShards* getShards() { return shards; }
+
+    // Read-modify-write one account under its stripe lock, or on its owning shard when sharding
+    // is enabled. The account is written back if the mutation returns true.
+    bool mutateAccount(const std::string& username, const AccountShards::Mutation& mutation);
+
+    // Account cache hit/miss counters
+    AccountCache::Stats getCacheStats();
 
-    // Update user in Redis
-    bool updateUser(const User& user);
+    struct UsernameFilterStats {
+        bool enabled;
+        uint64_t rejects;     // 被过滤器直接拒绝的查询
+        size_t items;
+        size_t capacity;
+        size_t memoryBytes;
+    };
+    UsernameFilterStats getUsernameFilterStats();
 
     // Get all users
     std::map<std::string, User> getAllUsers();
 
-    // Redis key helpers
+    // Storage key helpers
     static std::string getUserKey(const std::string& username);
     static std::string getUsersListKey();
 };
@@ -0,0 +1,69 @@
+// AccountShards.h - Shard-per-core executors that own account balances
+#ifndef ACCOUNT_SHARDS_H
+#define ACCOUNT_SHARDS_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "Common.h"
+
+class AccountManager;
+
+// 账户按用户名哈希划分到N个单线程分片，每个分片在自己的线程上持有其账户副本。
+// 对账户的修改以消息形式投递到所属分片依次执行，分片之间不共享可变状态。
+// 修改后同步写回AccountManager（缓存/账户表/存储），读取路径不受影响。
+// 副本不会因其他进程的写入而失效，因此要求本进程是账户余额的唯一写入方。
+class AccountShards {
+public:
+    // 返回true表示需要写回
+    typedef std::function<bool(AccountRecord&)> Mutation;
+
+private:
+    struct Shard {
+        // 只在本分片线程上访问
+        std::unordered_map<std::string, AccountRecord> accounts;
+
+        std::mutex queueMutex;
+        std::condition_variable queueReady;
+        std::deque<std::function<void()>> queue;
+        bool stopping;
+        std::thread thread;
+
+        Shard() : stopping(false) {}
+    };
+
+    AccountManager& accountManager;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    void run(Shard& shard, size_t index);
+
+    // 在分片线程上执行task并等待完成
+    void call(Shard& shard, const std::function<void()>& task);
+
+    // 分片线程内：取得账户副本（首次访问时从AccountManager加载）
+    AccountRecord* findAccount(Shard& shard, const std::string& username);
+
+public:
+    AccountShards(AccountManager& am, size_t shardCount);
+    ~AccountShards();
+
+    // Start one executor thread per shard, pinned to a CPU where supported
+    void start();
+    void stop();
+
+    size_t size() const { return shards.size(); }
+    size_t shardOf(const std::string& username) const;
+
+    // Run a mutation on the shard that owns the account and write the result back.
+    // Returns false if the account does not exist, the mutation declines, or the write fails
+    // (the shard's copy is left unchanged in that case). Must not be called from a shard thread.
+    bool mutate(const std::string& username, const Mutation& mutation);
+};
+
+#endif // ACCOUNT_SHARDS_H
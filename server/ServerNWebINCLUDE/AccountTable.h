@@ -0,0 +1,79 @@
+// AccountTable.h - Memory-mapped fixed-slot account table addressed by dense account ID
+#ifndef ACCOUNT_TABLE_H
+#define ACCOUNT_TABLE_H
+
+#include <string>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include "Money.h"
+
+// 固定大小的账户槽位（128字节，余额和用户名位于第一个缓存行）
+struct AccountSlot {
+    Money balance;            // 分
+    int32_t type;
+    uint32_t flags;
+    char username[48];
+    char password[64];
+};
+
+// 文件布局: [4KB文件头][capacity个槽位][开放寻址哈希索引（uint32，存放ID+1）]
+// 读取无锁且不分配内存；注册在insertMutex下进行，槽位写完后才发布到索引。
+// 索引项0表示空，TOMBSTONE表示已撤销的账户（查找时跳过）。
+class AccountTable {
+public:
+    static const uint32_t INVALID_ID = 0xFFFFFFFFu;
+    static const size_t MAX_USERNAME = sizeof(AccountSlot::username) - 1;
+    static const size_t MAX_PASSWORD = sizeof(AccountSlot::password) - 1;
+
+private:
+    struct Header;
+
+    std::string path;
+    uint32_t capacity;
+    uint32_t indexMask;
+
+    int fd;
+    char* base;
+    size_t mappedSize;
+
+    Header* header;
+    AccountSlot* slots;
+    uint32_t* buckets;
+
+    std::mutex insertMutex;
+
+    static uint64_t hashName(const char* name, size_t len);
+
+public:
+    AccountTable(const std::string& path, uint32_t capacity);
+    ~AccountTable();
+
+    // 打开或创建表文件
+    bool open();
+    void close();
+
+    // 查找账户ID，不存在返回INVALID_ID
+    uint32_t find(const std::string& username) const;
+
+    // 插入新账户；用户名已存在、超长或表已满时返回false
+    bool insert(const std::string& username, const std::string& password, int type, Money balance, uint32_t& id);
+
+    // 撤销insert（注册写入存储失败时）：索引项改为墓碑，槽位不再复用
+    void remove(uint32_t id);
+
+    // 清空全部账户（仅在开始服务前调用，不能与读者并发）
+    void clear();
+
+    const AccountSlot* slot(uint32_t id) const { return &slots[id]; }
+
+    Money readBalance(uint32_t id) const;
+    void writeBalance(uint32_t id, Money balance);
+
+    uint32_t size() const;
+
+    // 将脏页写回文件
+    bool flush();
+};
+
+#endif // ACCOUNT_TABLE_H
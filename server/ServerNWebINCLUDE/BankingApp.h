@@ -1,34 +1,40 @@
-// BankingApp.h - Main application class with Redis support (frontend functionality removed)
+// BankingApp.h - Main application class with pluggable storage (frontend functionality removed)
 #ifndef BANKING_APP_H
 #define BANKING_APP_H
 
 #include <string>
+#include <memory>
+#include "StorageBackend.h"
+#include "AccountTable.h"
+#include "AccountShards.h"
+#include "FakeRedisServer.h"
 #include "AccountManager.h"
 #include "TransactionManager.h"
 #include "DepositManager.h"
+#include "RecordConverter.h"
 #include "HttpServer.h"
 
 class BankingApp {
 private:
+    // Storage configuration and backend (shared by all managers)
+    StorageConfig storageConfig;
+    std::unique_ptr<FakeRedisServer> embeddedRedis;
+    std::unique_ptr<StorageBackend> storage;
+    std::unique_ptr<AccountTable> accountTable;
+
     // Components
     AccountManager accountManager;
+    std::unique_ptr<AccountShards> accountShards;
     TransactionManager transactionManager;
     DepositManager depositManager;
+    std::unique_ptr<RecordConverter> recordConverter;
     HttpServer httpServer;
 
     // Configuration
     int port;
 
-    // Redis configuration
-    std::string redisHost;
-    int redisPort;
-    std::string redisPassword;
-
 public:
-    BankingApp(int port,
-        const std::string& redisHost = "localhost",
-        int redisPort = 6379,
-        const std::string& redisPassword = "");
+    BankingApp(int port, const StorageConfig& storageConfig);
 
     // Run the application
     void run();
@@ -36,8 +42,8 @@ public:
     // Stop the application
     void stop();
 
-    // Initialize Redis connections
-    bool initRedis();
+    // Initialize the storage backend
+    bool initStorage();
 };
 
-#endif // BANKING_APP_H
\ No newline at end of file
+#endif // BANKING_APP_H
@@ -0,0 +1,46 @@
+// BloomFilter.h - Counting Bloom filter with 4-bit counters for set membership pre-checks
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// 计数布隆过滤器：mightContain返回false时元素一定不存在。
+// 每个计数器4位（两个一字节），满15后饱和不再减少。
+// add/remove/mightContain均无锁，可并发调用。
+class CountingBloomFilter {
+private:
+    std::vector<uint8_t> counters;
+    size_t slots;          // 计数器个数
+    unsigned hashes;       // 哈希函数个数
+    size_t capacity;       // 设计容量（超过后误判率上升）
+    std::atomic<size_t> items;
+    std::atomic<bool> ready;
+
+    void increment(size_t slot);
+    void decrement(size_t slot);
+    unsigned counter(size_t slot) const;
+
+    // 双重哈希: index_i = h1 + i * h2
+    static void hashPair(const std::string& item, uint64_t& h1, uint64_t& h2);
+
+public:
+    CountingBloomFilter(size_t expectedItems, double falsePositiveRate = 0.01);
+
+    void add(const std::string& item);
+    void remove(const std::string& item);
+    bool mightContain(const std::string& item) const;
+
+    // 构建期间未就绪，调用方不应据此判定元素不存在
+    bool isReady() const { return ready; }
+    void setReady() { ready = true; }
+
+    size_t size() const { return items; }
+    size_t getCapacity() const { return capacity; }
+    size_t memoryBytes() const { return counters.size(); }
+};
+
+#endif // BLOOM_FILTER_H
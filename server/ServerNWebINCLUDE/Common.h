@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <ctime>
+#include "Money.h"
 
 // User account type enumeration
 enum AccountType {
@@ -34,33 +35,68 @@ enum TransactionType {
     TRANSFER_OUT = 4   // ת
 };
 
+// Encoding used when writing transaction/deposit records
+enum RecordFormat {
+    RECORD_FORMAT_TEXT = 1,    // '|'ָıɰ汾ɶ
+    RECORD_FORMAT_BINARY = 2   // 汾ֽڵĽն
+};
+
 // Transaction record structure
 struct TransactionRecord {
     std::string id;               // ID
     TransactionType type;         // 
     std::string username;         // û
     std::string counterparty;     // ׶Էתʱ
-    double amount;                // ׽
-    double balance_after;         // ׺
+    Money amount;                 // ׽
+    Money balance_after;         // ׺
     std::string description;      // 
     time_t timestamp;             // ʱ
 
     // Default constructor
-    TransactionRecord() : type(DEPOSIT), amount(0.0), balance_after(0.0), timestamp(0) {}
+    TransactionRecord() : type(DEPOSIT), amount(0), balance_after(0), timestamp(0) {}
 };
 
 // Deposit structure
 struct Deposit {
     std::string id;         // IDʽ: "username-sequence"
     std::string username;   // û
-    double amount;          // 
+    Money amount;           // 
     DepositType type;       // 
     TimeDepositTerm term;   // ڴޣԶڴ
     time_t depositTime;     // ʱ
     bool isMatured;         // ڴǷѵ
 
     // Default constructor
-    Deposit() : amount(0.0), type(DEMAND_DEPOSIT), term(TWO_MINUTES), depositTime(0), isMatured(false) {}
+    Deposit() : amount(0), type(DEMAND_DEPOSIT), term(TWO_MINUTES), depositTime(0), isMatured(false) {}
+};
+
+// Lean account record for hot paths (no deposit/transaction vectors)
+struct AccountRecord {
+    std::string username;
+    std::string password;
+    AccountType type;
+    Money balance;
+
+    AccountRecord() : type(PRIVATE_ACCOUNT), balance(0) {}
+};
+
+// Result of a balance-changing operation
+struct TransactionResult {
+    bool success;
+    Money balance;                // תʱΪת
+    std::string transactionId;    // ɵĽID޽׼¼ĲΪգ
+    std::string depositId;        // 漰ĴID
+
+    TransactionResult() : success(false), balance(0) {}
+};
+
+// One page of a user's transaction history, newest first
+struct TransactionPage {
+    std::vector<TransactionRecord> transactions;
+    std::string nextCursor;       // ȡһҳα꣬Ϊձʾѵļ¼
+    size_t total;                 // ʷ¼
+
+    TransactionPage() : total(0) {}
 };
 
 // User structure
@@ -68,7 +104,7 @@ struct User {
     std::string username;
     std::string password;
     AccountType type;
-    double balance;
+    Money balance;
     std::vector<Deposit> deposits;                 // ûб
     std::vector<TransactionRecord> transactions;   // û׼¼
 };
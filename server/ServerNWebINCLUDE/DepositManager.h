@@ -1,50 +1,62 @@
-// DepositManager.h - Handles deposit creation and management with Redis
+// DepositManager.h - Handles deposit creation and management
 #ifndef DEPOSIT_MANAGER_H
 #define DEPOSIT_MANAGER_H
 
 #include <string>
 #include <vector>
 #include <map>
-#include <mutex>
 #include "AccountManager.h"
-#include "RedisClient.h"
+#include "StorageBackend.h"
+#include "LockStripes.h"
 
 class DepositManager {
 private:
     AccountManager& accountManager;
-    RedisClient redis;
-    std::mutex counterMutex; // ʵĻ
+    StorageBackend& storage;
+    RecordFormat recordFormat;   // д¼ĸʽȡָʽɣ
+    LockStripes depositLocks;    // û¼Ķ--дȡ㡢ʽ
 
-    // ΪָûһID
+    // ΪָûһIDʧܷؿմ
     std::string generateNextDepositId(const std::string& username);
 
-    // ûĴбɾָID
-    bool removeDepositFromUserList(const std::string& username, const std::string& deposit_id);
+    // У鲢ۼ¼ӦĽϢpreviousؿۼǰļ¼ʧʱڻָ
+    // ÷иûĴ
+    bool settleWithdrawal(const std::string& username, const std::string& deposit_id, Money amount, Money& credited,
+                          std::string& previous);
 
-public:
-    DepositManager(AccountManager& am);
+    // IDĩβţ"username-"
+    static unsigned long long depositSequence(const std::string& deposit_id);
 
-    // ӵRedis
-    bool connect();
+public:
+    DepositManager(AccountManager& am, StorageBackend& storage, RecordFormat recordFormat = RECORD_FORMAT_TEXT);
 
     // һ´
-    bool createDeposit(const std::string& username, double amount, int deposit_type, int deposit_term = 0);
+    TransactionResult createDeposit(const std::string& username, Money amount, int deposit_type, int deposit_term = 0);
 
-    // Ϣ
-    double calculateInterest(const Deposit& deposit, int seconds);
+    // Ϣ뵽֣
+    Money calculateInterest(const Deposit& deposit, int seconds);
 
-    // ȡûд
+    // ȡûдģʽ汾¼ʱ˳
     std::vector<Deposit> getUserDeposits(const std::string& username);
 
+    // ûľģʽ汾¼ǰʽдд
+    // ˻ƬִУḲǲȡͬһ¼޸
+    size_t upgradeDeposits(const std::string& username);
+
     // ȡضϸϢ
     Deposit getDepositDetails(const std::string& username, const std::string& deposit_id);
 
     // Ӵȡʽ𣨺Ϣ
-    bool withdrawDeposit(const std::string& username, const std::string& deposit_id, double amount);
+    TransactionResult withdrawDeposit(const std::string& username, const std::string& deposit_id, Money amount);
+
+    // ɰ֣¼+IDб/ϣתΪÿûһϣʱãظִУ
+    bool migrateDepositLayout();
 
-    // Redis
+    // 洢
     static std::string getUserDepositCounterKey(const std::string& username);
     static std::string getUserDepositsKey(const std::string& username);
+    static std::string getUserDepositIdsKey(const std::string& username);
+    static std::string getUserDepositRecordsKey(const std::string& username);
     static std::string getDepositKey(const std::string& username, const std::string& deposit_id);
 };
 
@@ -0,0 +1,86 @@
+// FakeRedisServer.h - Minimal RESP server emulating the Redis subset used by RedisClient
+#ifndef FAKE_REDIS_SERVER_H
+#define FAKE_REDIS_SERVER_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include "MemoryStorage.h"
+
+// 用于测试和压测的本地Redis替身，无需安装真实Redis。
+// 支持 PING/AUTH/SELECT/GET/SET/EXISTS/DEL/TYPE/EXPIRE/TTL/H*/LPUSH/RPUSH/LRANGE/LLEN/
+// MULTI/EXEC/DISCARD/FLUSHDB，以及hincrbyIfAtLeast/hsetIfEqual的EVAL脚本。与Redis一样所有命令串行执行，EXEC中的命令整体原子。
+// 过期采用惰性删除（访问时检查）。
+class FakeRedisServer {
+private:
+    // 单个客户端连接的状态
+    struct Session {
+        bool authenticated;
+        bool inMulti;
+        bool multiError;                           // 排队阶段出现错误，EXEC时放弃
+        std::vector<std::vector<std::string>> queued;
+
+        Session() : authenticated(false), inMulti(false), multiError(false) {}
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    int port;
+    std::string password;
+    std::atomic<unsigned> latencyUs;   // 每批回复前注入的延迟（模拟网络往返）
+
+    int serverFd;
+    std::atomic<bool> running;
+    std::thread acceptThread;
+
+    std::mutex clientsMutex;
+    std::vector<std::thread> clients;
+    std::set<int> clientFds;
+    std::set<std::thread::id> finishedClients;   // 连接已关闭、等待回收的线程
+
+    // 数据和过期时间，由commandMutex串行保护
+    std::mutex commandMutex;
+    MemoryStorage store;
+    std::unordered_map<std::string, Clock::time_point> expires;
+
+    void acceptLoop();
+    void handleClient(int clientFd);
+
+    // join已结束的连接线程，调用时持有clientsMutex
+    void reapClients();
+
+    // 处理一条命令（含AUTH/MULTI/EXEC等连接级命令），返回RESP编码的回复
+    std::string dispatch(Session& session, const std::vector<std::string>& args);
+
+    // 执行一条数据命令，调用时持有commandMutex
+    std::string execute(const std::vector<std::string>& args);
+
+    // 键已过期则删除
+    void expireIfNeeded(const std::string& key);
+
+    // 从缓冲区解析一条命令；不完整返回false，协议错误时设置error
+    static bool parseCommand(const std::string& buffer, size_t& pos, std::vector<std::string>& args, bool& error);
+
+    // 检查命令名和参数个数，出错时返回错误回复
+    static std::string checkCommand(const std::vector<std::string>& args);
+
+public:
+    FakeRedisServer(int port = 6379, const std::string& password = "", unsigned latencyUs = 0);
+    ~FakeRedisServer();
+
+    // 监听端口并在后台线程中接受连接；port为0时自动选择空闲端口
+    bool start();
+    void stop();
+
+    // 实际监听的端口
+    int getPort() const;
+
+    void setLatency(unsigned us);
+};
+
+#endif // FAKE_REDIS_SERVER_H
@@ -13,6 +13,8 @@
 #include "TransactionManager.h"
 #include "DepositManager.h"
 
+class JsonWriter;
+
 // HTTP handler function type
 using HttpHandler = std::function<std::string(const std::map<std::string, std::string>&)>;
 
@@ -35,6 +37,18 @@ private:
     void parseRequest(const std::string& request, std::string& method, std::string& path, std::map<std::string, std::string>& params);
     void sendResponse(int client_socket, const std::string& content_type, const std::string& content);
 
+    // 解析请求中的金额参数，格式无效时返回0（各操作会拒绝非正金额）
+    static Money parseAmount(const std::string& text);
+
+    // 响应体均由JsonWriter生成，字符串值统一转义
+    // {"status":"error","message":...}
+    static std::string errorResponse(const std::string& message);
+    // {"status":"success","message":...,"balance":...[,idKey:id]}，idKey为空时省略
+    static std::string balanceResponse(const char* message, const TransactionResult& result, const char* idKey,
+        const std::string& id);
+    // 存款的公共字段（不含外层括号）
+    static void writeDeposit(JsonWriter& json, const Deposit& deposit, time_t current_time);
+
     // Register all API route handlers
     void registerHandlers();
 
@@ -0,0 +1,37 @@
+// IdGenerator.h - Lock-free Snowflake-style unique ID generator
+#ifndef ID_GENERATOR_H
+#define ID_GENERATOR_H
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+// 64位ID：41位毫秒时间戳 | 10位节点ID | 12位序列号。
+// 同一节点生成的ID严格递增，不同节点（--node-id不同）的ID互不重复，按时间大致有序。
+// 不加锁、不访问存储。
+class IdGenerator {
+public:
+    static const unsigned NODE_BITS = 10;
+    static const unsigned SEQUENCE_BITS = 12;
+    static const unsigned MAX_NODE_ID = (1u << NODE_BITS) - 1;
+    static const uint64_t EPOCH_MS = 1704067200000ULL; // 2024-01-01 00:00:00 UTC
+
+private:
+    unsigned nodeId;
+    // 最近一次分配的 (时间戳 << SEQUENCE_BITS | 序列号)
+    std::atomic<uint64_t> last;
+
+    static uint64_t currentMillis();
+
+public:
+    explicit IdGenerator(unsigned nodeId = 0);
+
+    unsigned getNodeId() const { return nodeId; }
+
+    uint64_t next();
+
+    // 带前缀的定长十六进制形式，字典序与数值顺序一致
+    std::string nextString(const char* prefix);
+};
+
+#endif // ID_GENERATOR_H
@@ -0,0 +1,58 @@
+// JsonWriter.h - Append-only JSON builder writing into a single reusable buffer
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <string>
+#include <cstddef>
+#include "Money.h"
+
+// 按顺序写入键和值，逗号由写入器自动补全；所有字符串（含键）都按JSON规则转义。
+// 输出直接追加到内部缓冲区，不产生临时字符串。不检查结构是否合法，调用方保证begin/end配对。
+//   JsonWriter json;
+//   json.beginObject().key("status").string("success").key("balance").money(balance).endObject();
+class JsonWriter {
+private:
+    std::string out;
+    bool needComma;   // 上一个记号是完整的值（需要在下一个键/值前加逗号）
+
+    void separator() {
+        if (needComma) {
+            out += ',';
+        }
+        needComma = true;
+    }
+
+public:
+    explicit JsonWriter(size_t reserve = 256);
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    JsonWriter& key(const char* name);
+    JsonWriter& key(const std::string& name);
+
+    JsonWriter& string(const char* value);
+    JsonWriter& string(const std::string& value);
+    JsonWriter& integer(long long value);
+    JsonWriter& unsignedInteger(unsigned long long value);
+    // 可精确还原的最短十进制形式（依次尝试15-17位有效数字，%g去掉末尾的0）；NaN/无穷输出null
+    JsonWriter& number(double value);
+    // 两位小数的数字（与MoneyUtil::format一致）
+    JsonWriter& money(Money amount);
+    JsonWriter& boolean(bool value);
+    JsonWriter& null();
+
+    const std::string& str() const { return out; }
+    // 取走结果，写入器恢复为空
+    std::string release();
+
+    // 转义后追加（不含引号）：'"'、'\\'和控制字符，x86上按16字节块跳过无需转义的内容
+    static void appendEscaped(std::string& out, const char* data, size_t len);
+    static void appendInteger(std::string& out, long long value);
+    static void appendUnsigned(std::string& out, unsigned long long value);
+    static void appendNumber(std::string& out, double value);
+};
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,37 @@
+// LockStripes.h - Fixed set of mutexes striped by account name
+#ifndef LOCK_STRIPES_H
+#define LOCK_STRIPES_H
+
+#include <string>
+#include <mutex>
+#include <cstddef>
+
+// 按用户名哈希到固定数量的互斥锁，只有落在同一条带的账户才会互相等待。
+// 同时锁定两个账户时按条带下标升序加锁，避免相向转账死锁。
+class LockStripes {
+public:
+    static const size_t STRIPE_COUNT = 1024;
+
+    static size_t stripeIndex(const std::string& key);
+    std::mutex& stripe(size_t index) { return stripes[index]; }
+
+    // 作用域内持有一个或两个账户的条带锁
+    class Guard {
+    private:
+        std::mutex* locks[2];
+        size_t count;
+
+        Guard(const Guard&);
+        Guard& operator=(const Guard&);
+
+    public:
+        Guard(LockStripes& stripes, const std::string& key);
+        Guard(LockStripes& stripes, const std::string& first, const std::string& second);
+        ~Guard();
+    };
+
+private:
+    std::mutex stripes[STRIPE_COUNT];
+};
+
+#endif // LOCK_STRIPES_H
@@ -0,0 +1,65 @@
+// LogFormat.h - On-disk record format for the local storage engine's segment log
+#ifndef LOG_FORMAT_H
+#define LOG_FORMAT_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "StorageBackend.h"
+
+// Mutation types recorded in the log
+enum LogOp {
+    LOG_SET = 1,
+    LOG_DEL = 2,
+    LOG_HSET = 3,
+    LOG_HDEL = 4,
+    LOG_LPUSH = 5,
+    LOG_RPUSH = 6,
+    LOG_LSET = 7     // field为十进制下标
+};
+
+// One storage mutation
+struct LogRecord {
+    LogOp op;
+    uint64_t lsn;        // 全局递增的日志序号（版本1的段中为0）
+    std::string key;
+    std::string field;   // 哈希操作的字段；LSET的下标
+    std::string value;
+
+    LogRecord() : op(LOG_SET), lsn(0) {}
+};
+
+// Segment file header flags
+enum SegmentFlags {
+    SEGMENT_COMPACTED = 1   // 压缩生成的段：包含完整状态，覆盖所有更早的段
+};
+
+class LogFormat {
+public:
+    // 段文件头长度: "BKSG" + 版本 + 标志 + 2字节保留
+    static const size_t SEGMENT_HEADER_SIZE = 8;
+
+    // 帧格式: [u32 负载长度][u32 CRC32][负载]
+    static const size_t FRAME_HEADER_SIZE = 8;
+
+    static uint32_t crc32(const char* data, size_t len);
+
+    // 当前写入的段格式版本（版本2起记录带LSN）
+    static const uint8_t SEGMENT_VERSION = 2;
+
+    // 追加一条带帧头的记录到out（当前版本格式）
+    static void encode(const LogRecord& record, std::string& out);
+
+    // 从data[pos]处解码一条记录，成功后pos前进；数据不完整或校验失败返回false
+    static bool decode(const char* data, size_t len, size_t& pos, LogRecord& record,
+        uint8_t version = SEGMENT_VERSION);
+
+    // 将记录应用到存储
+    static bool apply(const LogRecord& record, StorageBackend& target);
+
+    // 段文件头
+    static std::string segmentHeader(uint8_t flags);
+    static bool parseSegmentHeader(const char* data, size_t len, uint8_t& flags, uint8_t& version);
+};
+
+#endif // LOG_FORMAT_H
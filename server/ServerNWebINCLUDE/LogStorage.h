@@ -0,0 +1,109 @@
+// LogStorage.h - Embedded log-structured storage engine (append-only segments + in-memory index)
+#ifndef LOG_STORAGE_H
+#define LOG_STORAGE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <cstdint>
+#include "StorageBackend.h"
+#include "MemoryStorage.h"
+#include "LogFormat.h"
+#include "WriteAheadLog.h"
+
+// 所有数据常驻内存（MemoryStorage作为哈希索引），每次修改追加写入当前段文件。
+// 段文件通过WriteAheadLog写入，sync()在所属批次刷盘后返回（组提交）。
+// 后台线程定期写入快照，快照覆盖的段随后删除；启动时加载最新快照并只重放其后的日志。
+class LogStorage : public StorageBackend {
+private:
+    std::string dataDir;
+    uint64_t segmentSize;        // 段文件滚动阈值（字节）
+    unsigned snapshotInterval;   // 快照间隔（秒）
+    size_t snapshotSegments;     // 封存段达到该数量时提前触发快照
+
+    MemoryStorage index;
+
+    // 与MemoryStorage分片一一对应的写锁，保证同一分片内日志顺序与内存应用顺序一致；
+    // shardLsn记录每个分片最后应用的日志序号，作为快照的一致性截止点
+    std::mutex stripes[MemoryStorage::SHARD_COUNT];
+    uint64_t shardLsn[MemoryStorage::SHARD_COUNT];
+
+    // 当前活动段（受logMutex保护）
+    std::mutex logMutex;
+    WriteAheadLog wal;
+    uint64_t activeId;
+    uint64_t activeSize;
+    uint64_t lastLsn;
+    std::vector<uint64_t> sealedSegments;
+
+    // 后台快照线程
+    std::thread snapshotter;
+    std::mutex snapshotMutex;
+    std::condition_variable snapshotCv;
+    bool stopping;
+    bool connected;
+
+    std::string segmentPath(uint64_t id) const;
+    std::string snapshotPath(uint64_t baseSegment) const;
+
+    // 启动时加载快照和段
+    bool recover();
+    bool replaySegment(uint64_t id, bool truncateTail, const std::vector<uint64_t>& cutLsns);
+
+    bool openSegment(uint64_t id);
+
+    // 分配LSN并追加到活动段，返回LSN（记录未写入时返回0）
+    uint64_t append(LogRecord& record);
+
+    // 记录能否改变内存索引（调用时持有键所属条带锁）
+    bool canApply(const LogRecord& record);
+
+    // 先写日志，成功后再应用到内存索引
+    bool mutate(LogRecord& record);
+
+    // 计数器先在索引上计算结果；日志写入失败时用以下函数恢复修改前的值（previous为空表示原先不存在）
+    void restoreString(const std::string& key, const std::string& previous);
+    void restoreField(const std::string& key, const std::string& field, const std::string& previous);
+
+    void snapshotLoop();
+    bool takeSnapshot();
+
+public:
+    LogStorage(const std::string& dataDir, uint64_t segmentSize, unsigned commitIntervalUs = 200,
+        unsigned snapshotInterval = 300, size_t snapshotSegments = 4);
+    ~LogStorage();
+
+    bool connect() override;
+    bool isConnected() const override;
+
+    bool set(const std::string& key, const std::string& value) override;
+    std::string get(const std::string& key) override;
+    bool exists(const std::string& key) override;
+    bool del(const std::string& key) override;
+    bool incr(const std::string& key, long long& value) override;
+
+    bool hset(const std::string& key, const std::string& field, const std::string& value) override;
+    std::string hget(const std::string& key, const std::string& field) override;
+    bool hexists(const std::string& key, const std::string& field) override;
+    bool hdel(const std::string& key, const std::string& field) override;
+    std::map<std::string, std::string> hgetall(const std::string& key) override;
+    bool hincrby(const std::string& key, const std::string& field, long long increment, long long& value) override;
+    bool hincrbyIfAtLeast(const std::string& key, const std::string& field, long long increment, long long minimum,
+                          long long& value) override;
+    bool hsetIfEqual(const std::string& key, const std::string& field, const std::string& expected,
+                     const std::string& value) override;
+
+    bool lpush(const std::string& key, const std::string& value) override;
+    bool rpush(const std::string& key, const std::string& value) override;
+    std::vector<std::string> lrange(const std::string& key, int start, int stop) override;
+    bool lset(const std::string& key, int index, const std::string& value) override;
+    size_t llen(const std::string& key) override;
+
+    bool sync() override;
+
+    std::string name() const override;
+};
+
+#endif // LOG_STORAGE_H
@@ -0,0 +1,89 @@
+// MemoryStorage.h - Sharded in-process StorageBackend (no Redis required)
+#ifndef MEMORY_STORAGE_H
+#define MEMORY_STORAGE_H
+
+#include <string>
+#include <map>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include "StorageBackend.h"
+
+class MemoryStorage : public StorageBackend {
+public:
+    // 分片数量（必须是2的幂）
+    static const size_t SHARD_COUNT = 64;
+
+private:
+    // 每个分片独立加锁，不同键之间互不阻塞
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::string> strings;
+        std::unordered_map<std::string, std::map<std::string, std::string>> hashes;
+        std::unordered_map<std::string, std::deque<std::string>> lists;
+    };
+
+    Shard shards[SHARD_COUNT];
+
+    Shard& shardFor(const std::string& key);
+
+    static bool parseInteger(const std::string& text, long long& value);
+
+public:
+    MemoryStorage();
+
+    bool connect() override;
+    bool isConnected() const override;
+
+    bool set(const std::string& key, const std::string& value) override;
+    std::string get(const std::string& key) override;
+    bool exists(const std::string& key) override;
+    bool del(const std::string& key) override;
+    bool incr(const std::string& key, long long& value) override;
+
+    bool hset(const std::string& key, const std::string& field, const std::string& value) override;
+    std::string hget(const std::string& key, const std::string& field) override;
+    bool hexists(const std::string& key, const std::string& field) override;
+    bool hdel(const std::string& key, const std::string& field) override;
+    std::map<std::string, std::string> hgetall(const std::string& key) override;
+    bool hincrby(const std::string& key, const std::string& field, long long increment, long long& value) override;
+    bool hincrbyIfAtLeast(const std::string& key, const std::string& field, long long increment, long long minimum,
+                          long long& value) override;
+    bool hsetIfEqual(const std::string& key, const std::string& field, const std::string& expected,
+                     const std::string& value) override;
+
+    bool lpush(const std::string& key, const std::string& value) override;
+    bool rpush(const std::string& key, const std::string& value) override;
+    std::vector<std::string> lrange(const std::string& key, int start, int stop) override;
+    bool lset(const std::string& key, int index, const std::string& value) override;
+    size_t llen(const std::string& key) override;
+
+    std::string name() const override;
+
+    // 键类型："string"/"hash"/"list"，不存在时为"none"（与TYPE命令一致）
+    std::string type(const std::string& key);
+
+    // 遍历存储内容（用于日志压缩等）
+    class Visitor {
+    public:
+        virtual ~Visitor() {}
+        virtual void onString(const std::string& key, const std::string& value) = 0;
+        virtual void onHash(const std::string& key, const std::map<std::string, std::string>& fields) = 0;
+        virtual void onList(const std::string& key, const std::deque<std::string>& items) = 0;
+    };
+
+    // 在分片锁内遍历单个分片
+    void visitShard(size_t index, Visitor& visitor);
+
+    // 逐个分片遍历全部内容（不是全局一致的时间点）
+    void visit(Visitor& visitor);
+
+    // 清空所有数据
+    void clear();
+
+    // 分片下标（稳定哈希，日志快照依赖该划分）
+    static size_t shardIndex(const std::string& key);
+};
+
+#endif // MEMORY_STORAGE_H
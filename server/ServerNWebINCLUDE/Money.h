@@ -0,0 +1,32 @@
+// Money.h - Fixed-point monetary amounts in minor currency units
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// 金额以最小货币单位（分）的64位整数表示：加减、比较和求和都是精确的整数运算
+typedef int64_t Money;
+
+class MoneyUtil {
+public:
+    static const Money UNITS_PER_MAJOR = 100;                 // 1元 = 100分
+    static const Money MAX_AMOUNT = 1000000000000000LL;       // 可解析的最大绝对值（10万亿元）
+
+    // 精确解析十进制金额："12"、"12.3"、"-0.05"；超过两位的小数必须为0，不接受指数形式
+    static bool parse(const std::string& text, Money& amount);
+    static bool parse(const char* text, size_t len, Money& amount);
+
+    // 固定两位小数的十进制形式，如 1234567.89、-0.05
+    static std::string format(Money amount);
+    static void append(std::string& out, Money amount);
+
+    // 旧数据中的浮点金额（可能为科学计数法），四舍五入到分
+    static Money fromDouble(double amount);
+
+    // amount * numerator / denominator，四舍五入（远离零），中间结果不溢出时精确
+    static Money scale(Money amount, int64_t numerator, int64_t denominator);
+};
+
+#endif // MONEY_H
@@ -0,0 +1,43 @@
+// RecordConverter.h - Background rewrite of records stored in older schema versions
+#ifndef RECORD_CONVERTER_H
+#define RECORD_CONVERTER_H
+
+#include <cstddef>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "StorageBackend.h"
+
+class TransactionManager;
+class DepositManager;
+
+// 后台线程按users列表逐个用户把旧模式版本的交易/存款记录改写为当前格式，完成一遍后退出。
+// 服务照常处理请求；读取路径遇到尚未转换的记录时自行升级，两者可以并行。
+// 以每秒改写的记录数限速（按用户粒度平均，单个用户的记录一次改写完）。
+class RecordConverter {
+private:
+    StorageBackend& storage;
+    TransactionManager& transactionManager;
+    DepositManager& depositManager;
+    unsigned recordsPerSecond;
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stopping;
+    std::thread thread;
+
+    void run();
+
+    // 刚改写了records条记录，按速率等待；被停止时返回false
+    bool throttle(size_t records);
+
+public:
+    RecordConverter(StorageBackend& storage, TransactionManager& tm, DepositManager& dm, unsigned recordsPerSecond);
+    ~RecordConverter();
+
+    void start();
+    // 中途停止时未转换的记录留待下次启动或读取时升级
+    void stop();
+};
+
+#endif // RECORD_CONVERTER_H
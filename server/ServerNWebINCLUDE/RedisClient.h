@@ -7,6 +7,7 @@
 #include <hiredis/hiredis.h>
 #include "Common.h"
 
+// ֵ%bȴݡظȶȡɴź\0ĶƼ¼
 class RedisClient {
 private:
     redisContext* context;
@@ -35,6 +36,7 @@ public:
     std::string get(const std::string& key);
     bool exists(const std::string& key);
     bool del(const std::string& key);
+    bool incr(const std::string& key, long long& value);
 
     // ϣ
     bool hset(const std::string& key, const std::string& field, const std::string& value);
@@ -42,11 +44,18 @@ public:
     bool hexists(const std::string& key, const std::string& field);
     bool hdel(const std::string& key, const std::string& field);
     std::map<std::string, std::string> hgetall(const std::string& key);
+    bool hincrby(const std::string& key, const std::string& field, long long increment, long long& value);
+    bool hincrbyIfAtLeast(const std::string& key, const std::string& field, long long increment, long long minimum,
+                          long long& value);
+    bool hsetIfEqual(const std::string& key, const std::string& field, const std::string& expected,
+                     const std::string& value);
 
     // б
     bool lpush(const std::string& key, const std::string& value);
     bool rpush(const std::string& key, const std::string& value);
     std::vector<std::string> lrange(const std::string& key, int start, int stop);
+    bool lset(const std::string& key, int index, const std::string& value);
+    size_t llen(const std::string& key);
 
     // 
     bool multi();
@@ -59,6 +68,15 @@ public:
     // ݿ
     bool flushdb();
 
+    // ͻ˻棺лRESP3Թ㲥ģʽָǰ׺ҪRedis 6+hiredis 1.0+
+    bool enableTracking(const std::vector<std::string>& prefixes);
+
+    // ȡһʧЧ֪ͨkeysΪձʾȫʧЧ
+    bool readInvalidation(std::vector<std::string>& keys);
+
+    // жеĶȡ̵߳ã
+    void interrupt();
+
     // 
     std::string getLastError() const;
 };
@@ -0,0 +1,81 @@
+// RedisStorage.h - StorageBackend implementation on top of a pool of Redis connections
+#ifndef REDIS_STORAGE_H
+#define REDIS_STORAGE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "StorageBackend.h"
+#include "RedisClient.h"
+
+class RedisStorage : public StorageBackend {
+private:
+    // hiredis上下文不是线程安全的，每个连接配一把锁
+    struct Connection {
+        RedisClient client;
+        std::mutex mutex;
+
+        Connection(const std::string& host, int port, const std::string& password)
+            : client(host, port, password) {}
+    };
+
+    std::vector<std::unique_ptr<Connection>> pool;
+    std::atomic<size_t> nextConnection;
+
+    std::string host;
+    int port;
+    std::string password;
+
+    // 失效通知专用连接（RESP3推送），由后台线程读取
+    std::unique_ptr<RedisClient> trackingClient;
+    std::mutex trackingMutex;
+    std::thread trackingThread;
+    std::atomic<bool> trackingStopping;
+    std::vector<std::string> trackingPrefixes;
+    InvalidationCallback trackingCallback;
+
+    // 轮询选取一个连接
+    Connection& acquire();
+
+    bool connectTracking();
+    void trackingLoop();
+
+public:
+    RedisStorage(const std::string& host, int port, const std::string& password, int poolSize);
+    ~RedisStorage();
+
+    bool connect() override;
+    bool isConnected() const override;
+
+    bool set(const std::string& key, const std::string& value) override;
+    std::string get(const std::string& key) override;
+    bool exists(const std::string& key) override;
+    bool del(const std::string& key) override;
+    bool incr(const std::string& key, long long& value) override;
+
+    bool hset(const std::string& key, const std::string& field, const std::string& value) override;
+    std::string hget(const std::string& key, const std::string& field) override;
+    bool hexists(const std::string& key, const std::string& field) override;
+    bool hdel(const std::string& key, const std::string& field) override;
+    std::map<std::string, std::string> hgetall(const std::string& key) override;
+    bool hincrby(const std::string& key, const std::string& field, long long increment, long long& value) override;
+    bool hincrbyIfAtLeast(const std::string& key, const std::string& field, long long increment, long long minimum,
+                          long long& value) override;
+    bool hsetIfEqual(const std::string& key, const std::string& field, const std::string& expected,
+                     const std::string& value) override;
+
+    bool lpush(const std::string& key, const std::string& value) override;
+    bool rpush(const std::string& key, const std::string& value) override;
+    std::vector<std::string> lrange(const std::string& key, int start, int stop) override;
+    bool lset(const std::string& key, int index, const std::string& value) override;
+    size_t llen(const std::string& key) override;
+
+    bool subscribeInvalidations(const std::vector<std::string>& prefixes, InvalidationCallback callback) override;
+
+    std::string name() const override;
+};
+
+#endif // REDIS_STORAGE_H
@@ -2,22 +2,105 @@
 #define SERIALIZER_H
 
 #include <string>
-#include <sstream>
+#include <map>
+#include <vector>
+#include <cstddef>
 #include "Common.h"
 
+// ּ¼ʽȡʱֽԶʶ
+//   ı'|'ֶָΣֽǿɴӡַģʽ汾0
+//   ƣֽΪ汾ţBINARY_VERSIONΪ䳤8ֽڽ֣ʹǰ׺ַ
+// ÿɶģʽ汾עеǼһ뺯ɰ汾¼ȡɵ÷ǰʽд
+// Ϊָɨ裬ֱд÷ṩĶ󣨿ɸַ
+// ׼¼ķָ16/32ֽڿSSE2/AVX2һζλʱCPUѡƽֽ̨ɨ裩
+// л׷ӵ÷Ļstringstream
 class Serializer {
+private:
+    // ıǰʽΪλСݰΪѧȡ뵽
+    static bool parseAmount(const char* text, size_t len, Money& amount);
+
+    static void appendUserBinary(const User& user, std::string& out);
+    static void appendTransactionBinary(const TransactionRecord& transaction, std::string& out);
+    static void appendDepositBinary(const Deposit& deposit, std::string& out);
+    static bool decodeUserBinary(const char* data, size_t len, User& user);
+    static bool decodeTransactionBinary(const char* data, size_t len, TransactionRecord& transaction);
+    static bool decodeDepositBinary(const char* data, size_t len, Deposit& deposit);
+    static bool decodeUserText(const char* data, size_t len, User& user);
+    static bool decodeTransactionText(const char* data, size_t len, TransactionRecord& transaction);
+    static bool decodeDepositText(const char* data, size_t len, Deposit& deposit);
+
+    // ģʽע汾 -> 뺯
+    struct Schema {
+        int version;
+        const char* name;
+        bool (*decodeUser)(const char* data, size_t len, User& user);
+        bool (*decodeTransaction)(const char* data, size_t len, TransactionRecord& transaction);
+        bool (*decodeDeposit)(const char* data, size_t len, Deposit& deposit);
+    };
+    static const Schema SCHEMAS[];
+    static const Schema* findSchema(const char* data, size_t len);
+
 public:
+    // Ƽ¼ĵǰ汾ֽڣı¼Կַͷ
+    static const unsigned char BINARY_VERSION = 1;
+
+    // ı¼ģʽ汾
+    static const int TEXT_SCHEMA = 0;
+
+    static bool isBinary(const char* data, size_t len);
+
+    // ¼ģʽ汾ռ¼δǼǵİ汾-1
+    static int schemaVersion(const char* data, size_t len);
+    // ָдʽӦĵǰģʽ汾
+    static int currentSchema(RecordFormat format);
+    // ¼Խ뵫formatĵǰ汾Ҫд
+    static bool needsUpgrade(const char* data, size_t len, RecordFormat format);
+
+    // "text" / "binary"
+    static bool parseRecordFormat(const std::string& name, RecordFormat& format);
+
     // ûл
-    static std::string serializeUser(const User& user);
+    static std::string serializeUser(const User& user, RecordFormat format = RECORD_FORMAT_TEXT);
+    static void appendUser(const User& user, std::string& out, RecordFormat format = RECORD_FORMAT_TEXT);
     static User deserializeUser(const std::string& data);
+    // ֶȱʧЧʱfalse
+    static bool deserializeUser(const char* data, size_t len, User& user);
+
+    // ɰ˻ַʽûʽͬǨ
+    static AccountRecord deserializeAccount(const std::string& data);
 
-    // ׼¼л
-    static std::string serializeTransaction(const TransactionRecord& transaction);
+    // ˻ϣֶΣpassword/type/balanceԷΪλţHINCRBYԭ
+    static const std::string ACCOUNT_PASSWORD_FIELD;
+    static const std::string ACCOUNT_TYPE_FIELD;
+    static const std::string ACCOUNT_BALANCE_FIELD;
+    static std::map<std::string, std::string> serializeAccountFields(const AccountRecord& account);
+    // ȱֶΣ˻ڻδд꣩ʱfalse
+    static bool deserializeAccountFields(const std::string& username,
+        const std::map<std::string, std::string>& fields, AccountRecord& account);
+
+    // ׼¼лк'|'ʱܽʱȡһֶΣ
+    static std::string serializeTransaction(const TransactionRecord& transaction,
+        RecordFormat format = RECORD_FORMAT_TEXT);
+    static void appendTransaction(const TransactionRecord& transaction, std::string& out,
+        RecordFormat format = RECORD_FORMAT_TEXT);
     static TransactionRecord deserializeTransaction(const std::string& data);
+    static bool deserializeTransaction(const char* data, size_t len, TransactionRecord& transaction);
+
+    // 루ʷдoutȰrecords.size()䣩سɹ
+    // ޷ļ¼±갴˳дfailed
+    static size_t deserializeTransactions(const std::vector<std::string>& records,
+        std::vector<TransactionRecord>& out, std::vector<size_t>& failed);
+
+    // ǰʹõķָɨʵ֣"avx2" / "sse2" / "scalar"
+    static const char* separatorScanner();
+    // ָɨʵ֣ѹԱãCPUֻ֧δ֪ʱfalse
+    static bool useSeparatorScanner(const std::string& name);
 
     // л
-    static std::string serializeDeposit(const Deposit& deposit);
+    static std::string serializeDeposit(const Deposit& deposit, RecordFormat format = RECORD_FORMAT_TEXT);
+    static void appendDeposit(const Deposit& deposit, std::string& out, RecordFormat format = RECORD_FORMAT_TEXT);
     static Deposit deserializeDeposit(const std::string& data);
+    static bool deserializeDeposit(const char* data, size_t len, Deposit& deposit);
 };
 
-#endif // SERIALIZER_H
\ No newline at end of file
+#endif // SERIALIZER_H
@@ -0,0 +1,67 @@
+// Snapshot.h - Compact binary point-in-time snapshot of the local storage engine
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <cstdint>
+#include "MemoryStorage.h"
+
+// 文件布局:
+//   "BKSN" + 版本 + 3字节保留
+//   每个分片一个数据区（类型 + 变长长度前缀的键/值）
+//   尾部索引: 分片数、基准段ID、每个分片的偏移/长度/截止LSN/CRC32
+//   索引CRC32 + 索引长度 + "BKSN"
+// 各分片数据区相互独立，加载时可并行解码。
+
+// 按分片写入快照；encodeShard可在分片锁内调用，writeShard在锁外写文件
+class SnapshotWriter : public MemoryStorage::Visitor {
+private:
+    std::string path;
+    std::string tmpPath;
+    int fd;
+    bool ok;
+    uint64_t offset;
+
+    std::string buffer;   // 当前分片的编码数据
+
+    struct ShardInfo {
+        uint64_t offset;
+        uint64_t size;
+        uint64_t cutLsn;
+        uint32_t crc;
+    };
+    std::vector<ShardInfo> shards;
+
+    bool writeBytes(const std::string& data);
+
+public:
+    SnapshotWriter(const std::string& path);
+    ~SnapshotWriter();
+
+    bool open();
+
+    // Visitor接口：编码到当前分片缓冲区
+    void onString(const std::string& key, const std::string& value) override;
+    void onHash(const std::string& key, const std::map<std::string, std::string>& fields) override;
+    void onList(const std::string& key, const std::deque<std::string>& items) override;
+
+    // 写出当前分片，cutLsn为该分片已包含的最后一条日志序号
+    bool writeShard(uint64_t cutLsn);
+
+    // 写入尾部索引，刷盘并原子重命名为最终文件
+    bool commit(uint64_t baseSegment);
+
+    uint64_t bytesWritten() const { return offset; }
+};
+
+class SnapshotReader {
+public:
+    // 加载快照到target，返回各分片截止LSN和基准段ID；threads为并行解码线程数
+    static bool load(const std::string& path, MemoryStorage& target,
+        std::vector<uint64_t>& cutLsns, uint64_t& baseSegment, unsigned threads);
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,141 @@
+// StorageBackend.h - Abstract key-value storage used by the managers
+#ifndef STORAGE_BACKEND_H
+#define STORAGE_BACKEND_H
+
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+#include <functional>
+#include "Common.h"
+
+// Storage engine selection
+enum StorageType {
+    STORAGE_REDIS = 1,   // 远程Redis服务器
+    STORAGE_MEMORY = 2,  // 进程内分片内存存储（无持久化）
+    STORAGE_LOCAL = 3    // 本地日志结构存储引擎（单机部署）
+};
+
+// Storage configuration
+struct StorageConfig {
+    StorageType type;
+
+    // Redis settings
+    std::string redisHost;
+    int redisPort;
+    std::string redisPassword;
+    int redisPoolSize;            // Redis连接池大小
+    bool redisTracking;           // 订阅RESP3失效通知，使本地缓存在多实例间保持一致
+    bool embeddedRedis;           // 在进程内启动Redis替身（测试/压测用）
+    unsigned embeddedRedisLatencyUs; // 替身注入的回复延迟（微秒）
+
+    // Local engine settings
+    std::string dataDir;          // 段文件目录
+    unsigned long long segmentSize; // 段文件滚动阈值（字节）
+    unsigned commitIntervalUs;    // 组提交间隔（微秒）
+    unsigned snapshotInterval;    // 快照间隔（秒）
+
+    // Optional memory-mapped account table
+    std::string accountTablePath; // 为空时不启用
+    unsigned accountTableCapacity; // 账户表槽位数
+    unsigned accountCacheSize;    // 进程内账户缓存容量，0表示禁用
+    unsigned usernameFilterCapacity; // 用户名布隆过滤器初始容量，0表示禁用
+    unsigned accountShards;       // 账户分片执行线程数，0表示使用条带锁
+    unsigned nodeId;              // 本实例节点ID（0-1023），多实例部署时各不相同以保证交易ID唯一
+    RecordFormat recordFormat;    // 交易/存款记录的写入格式
+    unsigned convertRecordsPerSec; // 后台把旧格式记录改写为recordFormat的速率（条/秒），0表示只在读取时升级
+
+    StorageConfig()
+        : type(STORAGE_REDIS), redisHost("localhost"), redisPort(6379), redisPoolSize(4),
+          redisTracking(false), embeddedRedis(false), embeddedRedisLatencyUs(0),
+          dataDir("data"), segmentSize(64ULL * 1024 * 1024), commitIntervalUs(200), snapshotInterval(300),
+          accountTableCapacity(1000000), accountCacheSize(10000),
+          usernameFilterCapacity(1000000), accountShards(0), nodeId(0),
+          recordFormat(RECORD_FORMAT_TEXT), convertRecordsPerSec(0) {}
+};
+
+// Redis上执行hincrbyIfAtLeast的脚本：KEYS[1]=键，ARGV=字段、增量、下限。
+// 余额以分为单位，远小于2^53，Lua的双精度比较不会丢失精度；实际增减仍由HINCRBY完成。
+// FakeRedisServer按原文识别同一脚本。
+const char HINCRBY_IF_AT_LEAST_SCRIPT[] =
+    "local v = redis.call('HGET', KEYS[1], ARGV[1]) "
+    "if not v then return false end "
+    "local n = tonumber(v) "
+    "if not n then return redis.error_reply('ERR hash value is not an integer') end "
+    "if n + tonumber(ARGV[2]) < tonumber(ARGV[3]) then return false end "
+    "return redis.call('HINCRBY', KEYS[1], ARGV[1], ARGV[2])";
+
+// Redis上执行hsetIfEqual的脚本：KEYS[1]=键，ARGV=字段、期望的旧值、新值。Lua字符串可含\0，按字节比较
+const char HSET_IF_EQUAL_SCRIPT[] =
+    "if redis.call('HGET', KEYS[1], ARGV[1]) ~= ARGV[2] then return 0 end "
+    "redis.call('HSET', KEYS[1], ARGV[1], ARGV[3]) "
+    "return 1";
+
+// Key-value storage interface (Redis data model subset)
+// Implementations must be safe to call from multiple threads.
+class StorageBackend {
+public:
+    virtual ~StorageBackend() {}
+
+    // 连接/初始化存储
+    virtual bool connect() = 0;
+    virtual bool isConnected() const = 0;
+
+    // 基本操作
+    virtual bool set(const std::string& key, const std::string& value) = 0;
+    virtual std::string get(const std::string& key) = 0;
+    virtual bool exists(const std::string& key) = 0;
+    virtual bool del(const std::string& key) = 0;
+
+    // 原子自增整数值（键不存在时视为0），value返回自增后的值；值不是整数时返回false
+    virtual bool incr(const std::string& key, long long& value) = 0;
+
+    // 哈希表操作
+    virtual bool hset(const std::string& key, const std::string& field, const std::string& value) = 0;
+    virtual std::string hget(const std::string& key, const std::string& field) = 0;
+    virtual bool hexists(const std::string& key, const std::string& field) = 0;
+    virtual bool hdel(const std::string& key, const std::string& field) = 0;
+    virtual std::map<std::string, std::string> hgetall(const std::string& key) = 0;
+
+    // 原子增减哈希字段中的整数（字段不存在时视为0），value返回结果；字段值不是整数时返回false
+    virtual bool hincrby(const std::string& key, const std::string& field, long long increment, long long& value) = 0;
+    // 仅当字段已存在且结果不小于minimum时才增减，检查与修改原子完成；
+    // 字段不存在、不是整数或结果低于minimum时不修改并返回false
+    virtual bool hincrbyIfAtLeast(const std::string& key, const std::string& field, long long increment,
+                                  long long minimum, long long& value) = 0;
+    // 仅当字段存在且当前值等于expected时写入value，比较与写入原子完成；否则不修改并返回false
+    virtual bool hsetIfEqual(const std::string& key, const std::string& field, const std::string& expected,
+                             const std::string& value) = 0;
+
+    // 列表操作
+    virtual bool lpush(const std::string& key, const std::string& value) = 0;
+    virtual bool rpush(const std::string& key, const std::string& value) = 0;
+    virtual std::vector<std::string> lrange(const std::string& key, int start, int stop) = 0;
+    // 替换下标index处的元素（负数从尾部计数）；列表不存在或下标越界时返回false
+    virtual bool lset(const std::string& key, int index, const std::string& value) = 0;
+    // 列表长度，不存在时为0
+    virtual size_t llen(const std::string& key) = 0;
+
+    // 阻塞直到此前的写入都已持久化（默认不需要等待）
+    virtual bool sync() { return true; }
+
+    // 订阅其他进程对指定前缀键的修改通知；keys为空表示全部失效（连接中断、FLUSHDB等）。
+    // 回调在后台线程执行。单进程存储无需订阅，默认返回false。
+    typedef std::function<void(const std::vector<std::string>& keys)> InvalidationCallback;
+    virtual bool subscribeInvalidations(const std::vector<std::string>& prefixes, InvalidationCallback callback) {
+        (void)prefixes;
+        (void)callback;
+        return false;
+    }
+
+    // 存储名称（用于日志）
+    virtual std::string name() const = 0;
+
+    // Create a backend from configuration
+    static std::unique_ptr<StorageBackend> create(const StorageConfig& config);
+
+    // Parse storage type name ("redis" / "memory" / "local"), returns false if unknown
+    static bool parseType(const std::string& name, StorageType& type);
+};
+
+#endif // STORAGE_BACKEND_H
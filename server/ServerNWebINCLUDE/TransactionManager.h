@@ -1,52 +1,75 @@
-// TransactionManager.h - Handles deposits, withdrawals, and transfers with Redis
+// TransactionManager.h - Handles deposits, withdrawals, and transfers
 #ifndef TRANSACTION_MANAGER_H
 #define TRANSACTION_MANAGER_H
 
 #include <string>
 #include <vector>
-#include <mutex>
 #include "AccountManager.h"
-#include "RedisClient.h"
+#include "StorageBackend.h"
+#include "IdGenerator.h"
 
 class TransactionManager {
 private:
     AccountManager& accountManager;
-    RedisClient redis;
-    std::mutex transaction_mutex;
-    int transaction_counter = 0;
+    StorageBackend& storage;
+    IdGenerator idGenerator;
+    RecordFormat recordFormat;   // ½׼¼дʽȡָʽɣ
 
     // ΨһID
     std::string generateTransactionId();
 
-    // 潻׼¼
-    void recordTransaction(const std::string& username, TransactionType type,
-        double amount, double balance_after,
+    // 潻׼¼ؽID
+    std::string recordTransaction(const std::string& username, TransactionType type,
+        Money amount, Money balance_after,
         const std::string& counterparty = "",
         const std::string& description = "");
 
-public:
-    TransactionManager(AccountManager& am);
+    // ǰʽдб±indexĽ׼¼
+    bool rewriteTransaction(const std::string& key, size_t index, const TransactionRecord& record);
+
+    // бд±firstʼ¼޷ģģʽ汾ļ¼˳д
+    void decodeRange(const std::string& key, size_t first, const std::vector<std::string>& serialized,
+        std::vector<TransactionRecord>& transactions);
+
+    // ҳα꣺һҳһ¼бе±
+    static std::string encodeCursor(size_t index);
+    static bool decodeCursor(const std::string& cursor, size_t& index);
+
+    // ׶תˣתۿտˣʧʱ˿ͬʱ˻
+    TransactionResult transferInPhases(const std::string& from_username, const std::string& to_username, Money amount);
 
-    // ӵRedis
-    bool connect();
+public:
+    // nodeIdֶʵɵĽID0-1023
+    TransactionManager(AccountManager& am, StorageBackend& storage, unsigned nodeId = 0,
+        RecordFormat recordFormat = RECORD_FORMAT_TEXT);
 
-    // 
-    bool deposit(const std::string& username, double amount);
+    // аͽID
+    TransactionResult deposit(const std::string& username, Money amount);
 
     // ȡ
-    bool withdraw(const std::string& username, double amount);
+    TransactionResult withdraw(const std::string& username, Money amount);
 
-    // ת
-    bool transfer(const std::string& from_username, const std::string& to_username, double amount);
+    // תˣΪתתID
+    TransactionResult transfer(const std::string& from_username, const std::string& to_username, Money amount);
 
     // ȡ
-    double getBalance(const std::string& username);
+    Money getBalance(const std::string& username);
 
-    // ȡûʷ
+    // ȡûʷģʽ汾ļ¼˳ǰʽд
     std::vector<TransactionRecord> getTransactionHistory(const std::string& username);
 
-    // Redis
-    static std::string getTransactionCounterKey();
+    static const size_t DEFAULT_HISTORY_PAGE = 50;
+    static const size_t MAX_HISTORY_PAGE = 1000;
+
+    // αҳȡʷ¼¼ǰֻȡҳlimit¼
+    // cursorΪʱµļ¼ʼΪһҳصnextCursorαЧʱfalse
+    bool getTransactionPage(const std::string& username, size_t limit, const std::string& cursor,
+        TransactionPage& page);
+
+    // ûľģʽ汾׼¼ǰʽдд̨תʹã
+    size_t upgradeTransactions(const std::string& username);
+
+    // 洢
     static std::string getUserTransactionsKey(const std::string& username);
 };
 
@@ -0,0 +1,67 @@
+// WriteAheadLog.h - Append-only log file with group commit (one fdatasync per batch)
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+#include <string>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+class WriteAheadLog {
+public:
+    struct Stats {
+        uint64_t records;   // 追加的记录数
+        uint64_t commits;   // 已确认持久化的提交数（sync调用）
+        uint64_t fsyncs;    // fdatasync调用次数
+    };
+
+private:
+    std::mutex mutex;
+    std::condition_variable appendedCv;   // 有新记录待刷盘
+    std::condition_variable durableCv;    // 一批记录已持久化
+
+    int fd;
+    uint64_t appendedLsn;    // 最后追加的记录序号
+    uint64_t durableLsn;     // 已持久化的记录序号
+    bool syncing;            // 提交线程正在刷盘（此时不能关闭fd）
+    bool failed;
+    bool stopping;
+
+    unsigned commitIntervalUs;
+    std::thread committer;
+
+    std::atomic<uint64_t> records;
+    std::atomic<uint64_t> commits;
+    std::atomic<uint64_t> fsyncs;
+
+    // 吞吐统计
+    Stats lastReport;
+    std::chrono::steady_clock::time_point lastReportTime;
+
+    void commitLoop();
+    void report(bool force);
+
+public:
+    WriteAheadLog(unsigned commitIntervalUs = 200);
+    ~WriteAheadLog();
+
+    // 启动/停止提交线程；停止时会刷盘并关闭文件
+    void start();
+    void stop();
+
+    // 切换到新的日志文件，旧文件先刷盘再关闭
+    bool switchFile(int newFd);
+
+    // 追加一条已编码的记录，返回其序号（失败返回0）
+    uint64_t append(const std::string& frame);
+
+    // 阻塞直到此前追加的所有记录都已持久化
+    bool sync();
+
+    Stats getStats() const;
+};
+
+#endif // WRITE_AHEAD_LOG_H
@@ -0,0 +1,160 @@
+// AccountCache.cpp - Implementation of the sharded LRU account cache
+#include "AccountCache.h"
+#include <functional>
+
+AccountCache::AccountCache(size_t capacity)
+    : capacity(capacity), shardCapacity(0), hits(0), misses(0), evictions(0), invalidations(0) {
+    if (capacity > 0) {
+        shardCapacity = (capacity + SHARD_COUNT - 1) / SHARD_COUNT;
+    }
+}
+
+AccountCache::Shard& AccountCache::shardFor(const std::string& username) {
+    return shards[std::hash<std::string>()(username) & (SHARD_COUNT - 1)];
+}
+
+bool AccountCache::get(const std::string& username, AccountRecord& account) {
+    if (capacity == 0) {
+        return false;
+    }
+
+    Shard& shard = shardFor(username);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(username);
+    if (it == shard.index.end()) {
+        misses++;
+        return false;
+    }
+
+    // 移到表头
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    account = *it->second;
+    hits++;
+    return true;
+}
+
+bool AccountCache::getBalance(const std::string& username, Money& balance) {
+    if (capacity == 0) {
+        return false;
+    }
+
+    Shard& shard = shardFor(username);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(username);
+    if (it == shard.index.end()) {
+        misses++;
+        return false;
+    }
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    balance = it->second->balance;
+    hits++;
+    return true;
+}
+
+uint64_t AccountCache::generation(const std::string& username) {
+    Shard& shard = shardFor(username);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.generation;
+}
+
+void AccountCache::put(const AccountRecord& account, uint64_t generation) {
+    if (capacity == 0) {
+        return;
+    }
+
+    Shard& shard = shardFor(account.username);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.generation != generation) {
+        return;
+    }
+    putLocked(shard, account);
+}
+
+void AccountCache::put(const AccountRecord& account) {
+    if (capacity == 0) {
+        return;
+    }
+
+    Shard& shard = shardFor(account.username);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // 使并发读取到的旧值失效
+    shard.generation++;
+    putLocked(shard, account);
+}
+
+void AccountCache::putLocked(Shard& shard, const AccountRecord& account) {
+    auto it = shard.index.find(account.username);
+    if (it != shard.index.end()) {
+        *it->second = account;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+
+    shard.lru.push_front(account);
+    shard.index[account.username] = shard.lru.begin();
+
+    if (shard.lru.size() > shardCapacity) {
+        shard.index.erase(shard.lru.back().username);
+        shard.lru.pop_back();
+        evictions++;
+    }
+}
+
+void AccountCache::updateBalance(const std::string& username, Money balance) {
+    if (capacity == 0) {
+        return;
+    }
+
+    Shard& shard = shardFor(username);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    shard.generation++;
+    auto it = shard.index.find(username);
+    if (it != shard.index.end()) {
+        it->second->balance = balance;
+    }
+}
+
+void AccountCache::invalidate(const std::string& username) {
+    if (capacity == 0) {
+        return;
+    }
+
+    Shard& shard = shardFor(username);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    shard.generation++;
+    auto it = shard.index.find(username);
+    if (it != shard.index.end()) {
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+        invalidations++;
+    }
+}
+
+void AccountCache::clear() {
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        shards[i].generation++;
+        shards[i].lru.clear();
+        shards[i].index.clear();
+    }
+}
+
+AccountCache::Stats AccountCache::getStats() {
+    Stats stats;
+    stats.hits = hits.load();
+    stats.misses = misses.load();
+    stats.evictions = evictions.load();
+    stats.invalidations = invalidations.load();
+    stats.capacity = capacity;
+    stats.size = 0;
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        stats.size += shards[i].lru.size();
+    }
+    return stats;
+}
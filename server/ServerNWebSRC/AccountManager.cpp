@@ -1,21 +1,196 @@
-// AccountManager.cpp - Implementation of account management with Redis
+// AccountManager.cpp - Implementation of account management
 #include "AccountManager.h"
 #include "Serializer.h"
 #include <iostream>
+#include <cstring>
 
-// Redis key prefixes
+// Storage key prefixes
 const std::string USER_KEY_PREFIX = "user:";
 const std::string USERS_LIST_KEY = "users";
 
-AccountManager::AccountManager(const std::string& redis_host, int redis_port, const std::string& redis_password) 
-    : redis(redis_host, redis_port, redis_password) {
+// 同在"user:"下但不是账户哈希的键族，与TransactionManager/DepositManager中的前缀一致（含旧版存款布局）
+const char* const USER_KEY_FAMILIES[] = {
+    "transactions:", "deposit_records:", "deposit_counter:", "deposits:", "deposit_ids:"
+};
+
+AccountManager::AccountManager(StorageBackend& storage, size_t cacheCapacity)
+    : storage(storage), table(nullptr), cache(cacheCapacity), shards(nullptr), filterRejects(0) {
 }
 
 AccountManager::~AccountManager() {
 }
 
-bool AccountManager::connect() {
-    return redis.connect();
+void AccountManager::setAccountTable(AccountTable* table) {
+    this->table = table;
+}
+
+void AccountManager::setShards(AccountShards* shards) {
+    this->shards = shards;
+}
+
+bool AccountManager::enableCacheInvalidation() {
+    if (table) {
+        return false;
+    }
+
+    return storage.subscribeInvalidations(std::vector<std::string>(1, USER_KEY_PREFIX),
+        [this](const std::vector<std::string>& keys) {
+            onInvalidation(keys);
+        });
+}
+
+void AccountManager::onInvalidation(const std::vector<std::string>& keys) {
+    std::shared_ptr<CountingBloomFilter> filter = std::atomic_load(&usernameFilter);
+    if (keys.empty()) {
+        // 可能错过了通知，缓存清空，过滤器重建
+        cache.clear();
+        if (filter) {
+            rebuildUsernameFilter(filter->getCapacity());
+        }
+        return;
+    }
+
+    for (const auto& key : keys) {
+        // 交易、存款等键的写入与账户缓存和用户名过滤器都无关，
+        // 其余部分不是用户名，记入过滤器只会增加计数和误判率
+        if (!isAccountKey(key)) {
+            continue;
+        }
+        std::string username = key.substr(USER_KEY_PREFIX.size());
+        cache.invalidate(username);
+
+        // 其他实例注册的新用户
+        if (filter && !filter->mightContain(username)) {
+            filter->add(username);
+        }
+    }
+}
+
+bool AccountManager::isAccountKey(const std::string& key) {
+    if (key.compare(0, USER_KEY_PREFIX.size(), USER_KEY_PREFIX) != 0) {
+        return false;
+    }
+    for (const char* family : USER_KEY_FAMILIES) {
+        if (key.compare(USER_KEY_PREFIX.size(), strlen(family), family) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AccountManager::enableUsernameFilter(size_t expectedUsers) {
+    if (table || expectedUsers == 0) {
+        return false;
+    }
+    return rebuildUsernameFilter(expectedUsers);
+}
+
+bool AccountManager::rebuildUsernameFilter(size_t expectedUsers) {
+    // 先发布未就绪的过滤器：构建期间的新注册和失效通知也会记入
+    std::shared_ptr<CountingBloomFilter> filter(new CountingBloomFilter(expectedUsers));
+    std::atomic_store(&usernameFilter, filter);
+
+    std::vector<std::string> usernames = storage.lrange(getUsersListKey(), 0, -1);
+    if (!storage.isConnected()) {
+        std::cerr << "无法读取用户列表，用户名过滤器未启用" << std::endl;
+        return false;
+    }
+    if (usernames.size() > expectedUsers) {
+        return rebuildUsernameFilter(usernames.size() * 2);
+    }
+
+    for (const auto& username : usernames) {
+        filter->add(username);
+    }
+    filter->setReady();
+    std::cout << "Username filter ready: " << usernames.size() << " users, "
+              << filter->memoryBytes() / 1024 << " KB" << std::endl;
+    return true;
+}
+
+bool AccountManager::mayExist(const std::string& username) {
+    std::shared_ptr<CountingBloomFilter> filter = std::atomic_load(&usernameFilter);
+    if (!filter || !filter->isReady() || filter->mightContain(username)) {
+        return true;
+    }
+    filterRejects++;
+    return false;
+}
+
+void AccountManager::fillUser(const AccountSlot& slot, User& user) {
+    user.username = slot.username;
+    user.password = slot.password;
+    user.type = static_cast<AccountType>(slot.type);
+    user.balance = slot.balance;
+}
+
+void AccountManager::fillAccount(const AccountSlot& slot, AccountRecord& account) {
+    account.username = slot.username;
+    account.password = slot.password;
+    account.type = static_cast<AccountType>(slot.type);
+    account.balance = slot.balance;
+}
+
+bool AccountManager::loadAccountTable() {
+    if (!table) {
+        return true;
+    }
+
+    // 账户表只是存储的副本，以存储为准每次打开时重建：内存存储重启后为空，
+    // 崩溃时mmap脏页与存储的落盘进度也可能不同，表中的余额不能直接沿用
+    table->clear();
+    std::vector<std::string> usernames = storage.lrange(getUsersListKey(), 0, -1);
+    for (const auto& username : usernames) {
+        AccountRecord account;
+        if (!readAccount(username, account)) {
+            continue;
+        }
+        uint32_t id = 0;
+        if (!table->insert(account.username, account.password, account.type, account.balance, id)) {
+            std::cerr << "无法导入用户到账户表: " << username << std::endl;
+            return false;
+        }
+    }
+    if (!usernames.empty()) {
+        std::cout << "Loaded " << table->size() << " users from storage into account table" << std::endl;
+    }
+    return table->flush();
+}
+
+bool AccountManager::readAccount(const std::string& username, AccountRecord& account) {
+    return Serializer::deserializeAccountFields(username, storage.hgetall(getUserKey(username)), account);
+}
+
+bool AccountManager::writeAccount(const AccountRecord& account) {
+    // 密码字段最后写入：读取方以密码字段判断账户是否完整存在
+    std::map<std::string, std::string> fields = Serializer::serializeAccountFields(account);
+    const std::string key = getUserKey(account.username);
+    return storage.hset(key, Serializer::ACCOUNT_BALANCE_FIELD, fields[Serializer::ACCOUNT_BALANCE_FIELD]) &&
+        storage.hset(key, Serializer::ACCOUNT_TYPE_FIELD, fields[Serializer::ACCOUNT_TYPE_FIELD]) &&
+        storage.hset(key, Serializer::ACCOUNT_PASSWORD_FIELD, fields[Serializer::ACCOUNT_PASSWORD_FIELD]);
+}
+
+bool AccountManager::migrateAccountLayout() {
+    // 旧版本把账户序列化为一个字符串；转换为哈希表后余额可以在服务端原子增减。
+    // 可重复执行：哈希表键上的GET返回空（类型不符），直接跳过
+    std::vector<std::string> usernames = storage.lrange(getUsersListKey(), 0, -1);
+    size_t migrated = 0;
+    for (const auto& username : usernames) {
+        std::string serialized = storage.get(getUserKey(username));
+        if (serialized.empty()) {
+            continue;
+        }
+        AccountRecord account = Serializer::deserializeAccount(serialized);
+        if (!storage.del(getUserKey(username)) || !writeAccount(account)) {
+            std::cerr << "账户迁移失败: " << username << std::endl;
+            return false;
+        }
+        migrated++;
+    }
+    if (migrated > 0) {
+        std::cout << "Migrated " << migrated << " accounts to the hash layout" << std::endl;
+    }
+    return storage.sync();
 }
 
 std::string AccountManager::getUserKey(const std::string& username) {
@@ -27,90 +202,234 @@ std::string AccountManager::getUsersListKey() {
 }
 
 bool AccountManager::registerUser(const std::string& username, const std::string& password, int account_type) {
-    std::lock_guard<std::mutex> lock(users_mutex);
+    // 同名注册落在同一条带，检查与写入之间不会插入另一次注册
+    LockStripes::Guard guard(accountLocks, username);
 
     // Check if username already exists
-    if (redis.exists(getUserKey(username))) {
+    if (table) {
+        // 账户表负责唯一性检查，超长用户名也在此拒绝
+        uint32_t id = 0;
+        if (!table->insert(username, password, account_type, 0, id)) {
+            return false;
+        }
+    }
+    else if (mayExist(username) && storage.exists(getUserKey(username))) {
         return false;
     }
 
     // Create new user
-    User new_user;
+    AccountRecord new_user;
     new_user.username = username;
     new_user.password = password;
     new_user.type = static_cast<AccountType>(account_type);
-    new_user.balance = 0.0;
+    new_user.balance = 0;
 
-    // 序列化并存储用户
-    std::string serialized = Serializer::serializeUser(new_user);
-    bool success = redis.set(getUserKey(username), serialized);
+    // 以哈希表存储用户
+    bool success = writeAccount(new_user);
+    if (!success && table) {
+        // 撤销账户表中的占位，允许之后重新注册
+        table->remove(table->find(username));
+    }
     
     // 将用户添加到用户列表
     if (success) {
-        redis.rpush(getUsersListKey(), username);
+        storage.rpush(getUsersListKey(), username);
     }
     
-    return success;
+    if (success && !table) {
+        cache.put(new_user);
+
+        std::shared_ptr<CountingBloomFilter> filter = std::atomic_load(&usernameFilter);
+        if (filter) {
+            filter->add(username);
+            // 超出设计容量后误判率上升，按两倍容量重建
+            if (filter->isReady() && filter->size() > filter->getCapacity()) {
+                rebuildUsernameFilter(filter->getCapacity() * 2);
+            }
+        }
+    }
+
+    // 等待注册信息持久化后再返回
+    return success && storage.sync();
+}
+
+bool AccountManager::loadAccount(const std::string& username, AccountRecord& account) {
+    if (cache.get(username, account)) {
+        return true;
+    }
+    if (!mayExist(username)) {
+        return false;
+    }
+
+    // 不加锁：读取期间若有更新，代数变化，旧值不会写入缓存
+    uint64_t generation = cache.generation(username);
+
+    // 一次HGETALL即可判断用户是否存在（不存在时返回空表）
+    if (!readAccount(username, account)) {
+        return false;
+    }
+    cache.put(account, generation);
+    return true;
 }
 
 bool AccountManager::authenticateUser(const std::string& username, const std::string& password) {
-    std::lock_guard<std::mutex> lock(users_mutex);
+    if (table) {
+        uint32_t id = table->find(username);
+        if (id == AccountTable::INVALID_ID) {
+            return false;
+        }
+        const AccountSlot* slot = table->slot(id);
+        return password.size() <= AccountTable::MAX_PASSWORD &&
+            memcmp(slot->password, password.data(), password.size()) == 0 &&
+            slot->password[password.size()] == '\0';
+    }
 
-    // 检查用户是否存在
-    if (!redis.exists(getUserKey(username))) {
+    AccountRecord account;
+    if (!loadAccount(username, account)) {
         return false;
     }
+    return account.password == password;
+}
 
-    // 获取用户信息并验证密码
-    std::string serialized = redis.get(getUserKey(username));
-    if (serialized.empty()) {
+bool AccountManager::getAccount(const std::string& username, AccountRecord& account) {
+    if (table) {
+        uint32_t id = table->find(username);
+        if (id == AccountTable::INVALID_ID) {
+            return false;
+        }
+        fillAccount(*table->slot(id), account);
+        account.balance = table->readBalance(id);
+        return true;
+    }
+
+    return loadAccount(username, account);
+}
+
+bool AccountManager::getBalance(const std::string& username, Money& balance) {
+    if (table) {
+        // 直接读取槽位，不分配内存
+        uint32_t id = table->find(username);
+        if (id == AccountTable::INVALID_ID) {
+            return false;
+        }
+        balance = table->readBalance(id);
+        return true;
+    }
+
+    // 缓存命中时只复制余额，不构造账户记录
+    if (cache.getBalance(username, balance)) {
+        return true;
+    }
+
+    AccountRecord account;
+    if (!loadAccount(username, account)) {
         return false;
     }
+    balance = account.balance;
+    return true;
+}
+
+bool AccountManager::updateAccount(const AccountRecord& account) {
+    if (table) {
+        uint32_t id = table->find(account.username);
+        if (id == AccountTable::INVALID_ID) {
+            return false;
+        }
+        table->writeBalance(id, account.balance);
+    }
     
-    User user = Serializer::deserializeUser(serialized);
-    return user.password == password;
+    // 注册后只有余额会变化，只写余额字段
+    bool success = storage.hset(getUserKey(account.username), Serializer::ACCOUNT_BALANCE_FIELD,
+        std::to_string(account.balance));
+
+    // 写入成功则更新缓存，失败则使缓存失效，下次从存储重新读取
+    if (success && !table) {
+        cache.put(account);
+    }
+    else {
+        cache.invalidate(account.username);
+    }
+    return success;
 }
 
-User* AccountManager::getUser(const std::string& username) {
-    std::lock_guard<std::mutex> lock(users_mutex);
+bool AccountManager::adjustBalance(const std::string& username, Money amount, Money& balance) {
+    // 分片副本或账户表槽位持有权威余额，仍在其上读-改-写
+    if (shards || table) {
+        return mutateAccount(username, [amount, &balance](AccountRecord& account) {
+            if (amount < 0 && account.balance < -amount) {
+                return false;
+            }
+            account.balance += amount;
+            balance = account.balance;
+            return true;
+        });
+    }
 
-    // 检查用户是否存在
-    if (!redis.exists(getUserKey(username))) {
-        return nullptr;
+    // 存储端在一次原子操作内确认余额字段存在（不会创建账户）且结果不为负，
+    // 余额不足时不会出现中间的负值。条带锁只保证本进程内缓存更新与存储结果的顺序一致
+    LockStripes::Guard guard(accountLocks, username);
+    long long result = 0;
+    if (!storage.hincrbyIfAtLeast(getUserKey(username), Serializer::ACCOUNT_BALANCE_FIELD, amount, 0, result)) {
+        cache.invalidate(username);
+        return false;
     }
 
-    // 获取用户信息
-    std::string serialized = redis.get(getUserKey(username));
-    if (serialized.empty()) {
-        return nullptr;
+    balance = result;
+    cache.updateBalance(username, balance);
+    return true;
+}
+
+bool AccountManager::mutateAccount(const std::string& username, const AccountShards::Mutation& mutation) {
+    if (shards) {
+        return shards->mutate(username, mutation);
     }
-    
-    // 反序列化为用户对象
-    User* user = new User(Serializer::deserializeUser(serialized));
-    return user;
+
+    LockStripes::Guard guard(accountLocks, username);
+    AccountRecord account;
+    return getAccount(username, account) && mutation(account) && updateAccount(account);
 }
 
-bool AccountManager::updateUser(const User& user) {
-    std::lock_guard<std::mutex> lock(users_mutex);
-    
-    // 序列化并存储用户
-    std::string serialized = Serializer::serializeUser(user);
-    return redis.set(getUserKey(user.username), serialized);
+AccountCache::Stats AccountManager::getCacheStats() {
+    return cache.getStats();
+}
+
+AccountManager::UsernameFilterStats AccountManager::getUsernameFilterStats() {
+    UsernameFilterStats stats;
+    std::shared_ptr<CountingBloomFilter> filter = std::atomic_load(&usernameFilter);
+    stats.enabled = filter && filter->isReady();
+    stats.rejects = filterRejects.load();
+    stats.items = filter ? filter->size() : 0;
+    stats.capacity = filter ? filter->getCapacity() : 0;
+    stats.memoryBytes = filter ? filter->memoryBytes() : 0;
+    return stats;
 }
 
 std::map<std::string, User> AccountManager::getAllUsers() {
-    std::lock_guard<std::mutex> lock(users_mutex);
     std::map<std::string, User> users;
-    
+
+    if (table) {
+        uint32_t count = table->size();
+        for (uint32_t id = 0; id < count; id++) {
+            User user;
+            fillUser(*table->slot(id), user);
+            user.balance = table->readBalance(id);
+            users[user.username] = user;
+        }
+        return users;
+    }
+
     // 获取所有用户名
-    std::vector<std::string> usernames = redis.lrange(getUsersListKey(), 0, -1);
+    std::vector<std::string> usernames = storage.lrange(getUsersListKey(), 0, -1);
     
     // 获取每个用户的详细信息
     for (const auto& username : usernames) {
-        std::string serialized = redis.get(getUserKey(username));
-        if (!serialized.empty()) {
-            User user = Serializer::deserializeUser(serialized);
-            users[username] = user;
+        AccountRecord account;
+        if (readAccount(username, account)) {
+            User& user = users[username];
+            user.username = account.username;
+            user.password = account.password;
+            user.type = account.type;
+            user.balance = account.balance;
         }
     }
     
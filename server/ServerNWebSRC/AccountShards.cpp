@@ -0,0 +1,135 @@
+// AccountShards.cpp - Implementation of the shard-per-core account executors
+#include "AccountShards.h"
+#include "AccountManager.h"
+#include <future>
+#include <iostream>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+AccountShards::AccountShards(AccountManager& am, size_t shardCount)
+    : accountManager(am) {
+    if (shardCount == 0) {
+        shardCount = 1;
+    }
+    for (size_t i = 0; i < shardCount; i++) {
+        shards.push_back(std::unique_ptr<Shard>(new Shard()));
+    }
+}
+
+AccountShards::~AccountShards() {
+    stop();
+}
+
+void AccountShards::start() {
+    for (size_t i = 0; i < shards.size(); i++) {
+        Shard& shard = *shards[i];
+        if (shard.thread.joinable()) {
+            continue;
+        }
+        shard.stopping = false;
+        shard.thread = std::thread(&AccountShards::run, this, std::ref(shard), i);
+    }
+}
+
+void AccountShards::stop() {
+    for (auto& shard : shards) {
+        {
+            std::lock_guard<std::mutex> lock(shard->queueMutex);
+            shard->stopping = true;
+        }
+        shard->queueReady.notify_one();
+    }
+    for (auto& shard : shards) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+}
+
+size_t AccountShards::shardOf(const std::string& username) const {
+    return std::hash<std::string>()(username) % shards.size();
+}
+
+void AccountShards::run(Shard& shard, size_t index) {
+#ifdef __linux__
+    // 每个分片绑定一个核，核数不足时轮转
+    unsigned cores = std::thread::hardware_concurrency();
+    if (cores > 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(index % cores, &cpus);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+#else
+    (void)index;
+#endif
+
+    std::deque<std::function<void()>> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(shard.queueMutex);
+            shard.queueReady.wait(lock, [&shard]() { return shard.stopping || !shard.queue.empty(); });
+            if (shard.queue.empty()) {
+                return;
+            }
+            // 一次取走全部消息，执行期间不持有队列锁
+            batch.swap(shard.queue);
+        }
+        while (!batch.empty()) {
+            batch.front()();
+            batch.pop_front();
+        }
+    }
+}
+
+void AccountShards::call(Shard& shard, const std::function<void()>& task) {
+    std::promise<void> done;
+    std::future<void> finished = done.get_future();
+    {
+        std::lock_guard<std::mutex> lock(shard.queueMutex);
+        if (shard.stopping || !shard.thread.joinable()) {
+            // 分片未运行，消息丢弃，调用方得到失败结果
+            return;
+        }
+        shard.queue.push_back([&task, &done]() {
+            task();
+            done.set_value();
+        });
+    }
+    shard.queueReady.notify_one();
+    finished.wait();
+}
+
+AccountRecord* AccountShards::findAccount(Shard& shard, const std::string& username) {
+    auto it = shard.accounts.find(username);
+    if (it != shard.accounts.end()) {
+        return &it->second;
+    }
+
+    AccountRecord account;
+    if (!accountManager.getAccount(username, account)) {
+        return nullptr;
+    }
+    return &(shard.accounts[username] = account);
+}
+
+bool AccountShards::mutate(const std::string& username, const Mutation& mutation) {
+    Shard& shard = *shards[shardOf(username)];
+    bool success = false;
+
+    call(shard, [&]() {
+        AccountRecord* account = findAccount(shard, username);
+        if (!account) {
+            return;
+        }
+        // 先改副本，写回成功后才替换分片内的账户
+        AccountRecord updated = *account;
+        if (mutation(updated) && accountManager.updateAccount(updated)) {
+            *account = updated;
+            success = true;
+        }
+    });
+    return success;
+}
@@ -0,0 +1,257 @@
+// AccountTable.cpp - Implementation of the memory-mapped account table
+#include "AccountTable.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+const char TABLE_MAGIC[4] = { 'B', 'K', 'A', 'T' };
+// 版本2起余额为整数分（版本1为double）
+const uint32_t TABLE_VERSION = 2;
+const size_t TABLE_HEADER_SIZE = 4096;
+// 已撤销账户的索引项（ID+1不会达到该值）
+const uint32_t TOMBSTONE = 0xFFFFFFFFu;
+
+// 索引大小为不小于2倍容量的2的幂，负载因子不超过0.5
+uint32_t indexSizeFor(uint32_t capacity) {
+    uint64_t size = 1;
+    while (size < static_cast<uint64_t>(capacity) * 2) {
+        size <<= 1;
+    }
+    return static_cast<uint32_t>(size);
+}
+
+size_t fileSizeFor(uint32_t capacity) {
+    return TABLE_HEADER_SIZE + static_cast<size_t>(capacity) * sizeof(AccountSlot) +
+        static_cast<size_t>(indexSizeFor(capacity)) * sizeof(uint32_t);
+}
+
+bool nameEquals(const AccountSlot& slot, const char* name, size_t len) {
+    return memcmp(slot.username, name, len) == 0 && slot.username[len] == '\0';
+}
+
+} // namespace
+
+struct AccountTable::Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t slotSize;
+    uint32_t capacity;
+    uint32_t indexSize;
+    uint32_t count;
+};
+
+AccountTable::AccountTable(const std::string& path, uint32_t capacity)
+    : path(path), capacity(capacity), indexMask(0), fd(-1), base(nullptr), mappedSize(0),
+      header(nullptr), slots(nullptr), buckets(nullptr) {
+}
+
+AccountTable::~AccountTable() {
+    close();
+}
+
+uint64_t AccountTable::hashName(const char* name, size_t len) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= static_cast<unsigned char>(name[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool AccountTable::open() {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        std::cerr << "无法打开账户表 " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        close();
+        return false;
+    }
+
+    bool created = st.st_size == 0;
+    if (!created) {
+        // 已存在的表以文件头中的容量为准
+        Header existing;
+        bool readable = ::pread(fd, &existing, sizeof(existing), 0) == static_cast<ssize_t>(sizeof(existing)) &&
+            memcmp(existing.magic, TABLE_MAGIC, 4) == 0;
+        if (readable && existing.version < TABLE_VERSION) {
+            // 账户表只是存储的副本：旧版本的表清空后由loadAccountTable从存储重新导入
+            std::cout << "Account table " << path << " has format version " << existing.version
+                      << ", rebuilding from storage" << std::endl;
+            created = true;
+        }
+        else if (!readable || existing.version != TABLE_VERSION ||
+            existing.slotSize != sizeof(AccountSlot) || existing.capacity == 0 ||
+            existing.indexSize != indexSizeFor(existing.capacity) ||
+            static_cast<size_t>(st.st_size) < fileSizeFor(existing.capacity)) {
+            std::cerr << "账户表文件格式无效: " << path << std::endl;
+            close();
+            return false;
+        }
+        else if (existing.capacity != capacity) {
+            std::cout << "Account table " << path << " has capacity " << existing.capacity
+                      << ", ignoring requested " << capacity << std::endl;
+            capacity = existing.capacity;
+        }
+    }
+    if (created && (capacity == 0 || ::ftruncate(fd, 0) != 0 ||
+                    ::ftruncate(fd, static_cast<off_t>(fileSizeFor(capacity))) != 0)) {
+        // 稀疏文件：未使用的槽位不占磁盘
+        std::cerr << "无法分配账户表 " << path << ": " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+
+    mappedSize = fileSizeFor(capacity);
+    void* mapped = ::mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "账户表mmap失败: " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+
+    base = static_cast<char*>(mapped);
+    header = reinterpret_cast<Header*>(base);
+    slots = reinterpret_cast<AccountSlot*>(base + TABLE_HEADER_SIZE);
+    buckets = reinterpret_cast<uint32_t*>(base + TABLE_HEADER_SIZE + static_cast<size_t>(capacity) * sizeof(AccountSlot));
+    indexMask = indexSizeFor(capacity) - 1;
+
+    if (created) {
+        memcpy(header->magic, TABLE_MAGIC, 4);
+        header->version = TABLE_VERSION;
+        header->slotSize = sizeof(AccountSlot);
+        header->capacity = capacity;
+        header->indexSize = indexSizeFor(capacity);
+        header->count = 0;
+    }
+    return true;
+}
+
+void AccountTable::close() {
+    if (base != nullptr) {
+        ::msync(base, mappedSize, MS_SYNC);
+        ::munmap(base, mappedSize);
+        base = nullptr;
+        header = nullptr;
+        slots = nullptr;
+        buckets = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+uint32_t AccountTable::find(const std::string& username) const {
+    if (username.size() > MAX_USERNAME || buckets == nullptr) {
+        return INVALID_ID;
+    }
+
+    uint32_t i = static_cast<uint32_t>(hashName(username.data(), username.size())) & indexMask;
+    while (true) {
+        uint32_t bucket = __atomic_load_n(&buckets[i], __ATOMIC_ACQUIRE);
+        if (bucket == 0) {
+            return INVALID_ID;
+        }
+        if (bucket != TOMBSTONE && nameEquals(slots[bucket - 1], username.data(), username.size())) {
+            return bucket - 1;
+        }
+        i = (i + 1) & indexMask;
+    }
+}
+
+bool AccountTable::insert(const std::string& username, const std::string& password, int type, Money balance,
+                          uint32_t& id) {
+    if (username.empty() || username.size() > MAX_USERNAME || password.size() > MAX_PASSWORD ||
+        header == nullptr) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(insertMutex);
+    if (find(username) != INVALID_ID) {
+        return false;
+    }
+
+    uint32_t count = __atomic_load_n(&header->count, __ATOMIC_RELAXED);
+    if (count >= capacity) {
+        std::cerr << "账户表已满: " << path << std::endl;
+        return false;
+    }
+
+    // 先写槽位，再通过索引发布，读者看到索引项时槽位已完整
+    id = count;
+    AccountSlot& slot = slots[id];
+    memset(&slot, 0, sizeof(slot));
+    slot.balance = balance;
+    slot.type = type;
+    slot.flags = 1;
+    memcpy(slot.username, username.data(), username.size());
+    memcpy(slot.password, password.data(), password.size());
+    __atomic_store_n(&header->count, count + 1, __ATOMIC_RELEASE);
+
+    uint32_t i = static_cast<uint32_t>(hashName(username.data(), username.size())) & indexMask;
+    while (__atomic_load_n(&buckets[i], __ATOMIC_RELAXED) != 0) {
+        i = (i + 1) & indexMask;
+    }
+    __atomic_store_n(&buckets[i], id + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void AccountTable::remove(uint32_t id) {
+    std::lock_guard<std::mutex> lock(insertMutex);
+    if (header == nullptr || id >= __atomic_load_n(&header->count, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    // 不能把后面的项前移：无锁读者可能正在探测
+    const AccountSlot& slot = slots[id];
+    uint32_t i = static_cast<uint32_t>(hashName(slot.username, strlen(slot.username))) & indexMask;
+    while (true) {
+        uint32_t bucket = __atomic_load_n(&buckets[i], __ATOMIC_RELAXED);
+        if (bucket == 0) {
+            return;
+        }
+        if (bucket == id + 1) {
+            __atomic_store_n(&buckets[i], TOMBSTONE, __ATOMIC_RELEASE);
+            slots[id].flags = 0;
+            return;
+        }
+        i = (i + 1) & indexMask;
+    }
+}
+
+void AccountTable::clear() {
+    std::lock_guard<std::mutex> lock(insertMutex);
+    if (header == nullptr) {
+        return;
+    }
+    memset(buckets, 0, static_cast<size_t>(indexMask + 1) * sizeof(uint32_t));
+    __atomic_store_n(&header->count, 0, __ATOMIC_RELEASE);
+}
+
+Money AccountTable::readBalance(uint32_t id) const {
+    Money balance;
+    __atomic_load(&slots[id].balance, &balance, __ATOMIC_RELAXED);
+    return balance;
+}
+
+void AccountTable::writeBalance(uint32_t id, Money balance) {
+    __atomic_store(&slots[id].balance, &balance, __ATOMIC_RELAXED);
+}
+
+uint32_t AccountTable::size() const {
+    return header ? __atomic_load_n(&header->count, __ATOMIC_ACQUIRE) : 0;
+}
+
+bool AccountTable::flush() {
+    return base == nullptr || ::msync(base, mappedSize, MS_ASYNC) == 0;
+}
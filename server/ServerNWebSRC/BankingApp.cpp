@@ -3,47 +3,105 @@
 #include <iostream>
 #include <csignal>
 
-BankingApp::BankingApp(int port,
-                     const std::string& redisHost, int redisPort, const std::string& redisPassword)
-    : port(port),
-      redisHost(redisHost),
-      redisPort(redisPort),
-      redisPassword(redisPassword),
-      accountManager(redisHost, redisPort, redisPassword),
-      transactionManager(accountManager),
-      depositManager(accountManager),
-      httpServer(port, accountManager, transactionManager, depositManager) {
+BankingApp::BankingApp(int port, const StorageConfig& storageConfig)
+    : storageConfig(storageConfig),
+      storage(StorageBackend::create(storageConfig)),
+      accountManager(*storage, storageConfig.accountCacheSize),
+      transactionManager(accountManager, *storage, storageConfig.nodeId, storageConfig.recordFormat),
+      depositManager(accountManager, *storage, storageConfig.recordFormat),
+      httpServer(port, accountManager, transactionManager, depositManager),
+      port(port) {
 }
 
-bool BankingApp::initRedis() {
-    std::cout << "Connecting to Redis at " << redisHost << ":" << redisPort << "..." << std::endl;
-    
-    // 连接AccountManager的Redis
-    if (!accountManager.connect()) {
-        std::cerr << "Failed to connect AccountManager to Redis" << std::endl;
+bool BankingApp::initStorage() {
+    if (storageConfig.type == STORAGE_REDIS && storageConfig.embeddedRedis) {
+        // 进程内Redis替身，经过完整的RESP/网络路径
+        embeddedRedis.reset(new FakeRedisServer(storageConfig.redisPort, storageConfig.redisPassword,
+            storageConfig.embeddedRedisLatencyUs));
+        if (!embeddedRedis->start()) {
+            std::cerr << "Failed to start embedded Redis" << std::endl;
+            return false;
+        }
+    }
+
+    if (storageConfig.type == STORAGE_REDIS) {
+        std::cout << "Connecting to Redis at " << storageConfig.redisHost << ":" << storageConfig.redisPort
+                  << " (" << storageConfig.redisPoolSize << " connections)..." << std::endl;
+    }
+    else {
+        std::cout << "Initializing " << storage->name() << " storage..." << std::endl;
+    }
+
+    // 所有管理器共享同一个存储后端
+    if (!storage->connect()) {
+        std::cerr << "Failed to initialize " << storage->name() << " storage" << std::endl;
         return false;
     }
-    
-    // 连接TransactionManager的Redis
-    if (!transactionManager.connect()) {
-        std::cerr << "Failed to connect TransactionManager to Redis" << std::endl;
+
+    std::cout << "Storage backend ready: " << storage->name() << std::endl;
+
+    // 转换旧版账户布局（字符串 -> 哈希表），需在加载账户表之前完成
+    if (!accountManager.migrateAccountLayout()) {
         return false;
     }
-    
-    // 连接DepositManager的Redis
-    if (!depositManager.connect()) {
-        std::cerr << "Failed to connect DepositManager to Redis" << std::endl;
+
+    // 启用内存映射账户表
+    if (!storageConfig.accountTablePath.empty()) {
+        accountTable.reset(new AccountTable(storageConfig.accountTablePath, storageConfig.accountTableCapacity));
+        if (!accountTable->open()) {
+            std::cerr << "Failed to open account table " << storageConfig.accountTablePath << std::endl;
+            return false;
+        }
+        accountManager.setAccountTable(accountTable.get());
+        if (!accountManager.loadAccountTable()) {
+            return false;
+        }
+        std::cout << "Account table ready: " << accountTable->size() << " accounts" << std::endl;
+    }
+
+    // 多实例部署时由Redis推送失效通知（需在构建用户名过滤器之前订阅）
+    if (storageConfig.type == STORAGE_REDIS && storageConfig.redisTracking) {
+        if (accountManager.enableCacheInvalidation()) {
+            std::cout << "Redis client-side caching enabled" << std::endl;
+        }
+        else {
+            std::cerr << "Redis client tracking unavailable, account cache is not shared-safe" << std::endl;
+        }
+    }
+
+    // 转换旧版存款布局
+    if (!depositManager.migrateDepositLayout()) {
         return false;
     }
-    
-    std::cout << "All Redis connections established successfully" << std::endl;
+
+    // 分片执行：账户修改投递到所属分片线程，分片内存中的账户副本以本进程为唯一写入方
+    // （main中已拒绝与--redis-tracking同用）
+    if (storageConfig.accountShards > 0) {
+        accountShards.reset(new AccountShards(accountManager, storageConfig.accountShards));
+        accountShards->start();
+        accountManager.setShards(accountShards.get());
+        std::cout << "Account shards ready: " << accountShards->size() << " executors" << std::endl;
+    }
+
+    // 共享Redis且没有失效通知时main已默认关闭过滤器
+    if (storageConfig.usernameFilterCapacity > 0 && !accountTable) {
+        accountManager.enableUsernameFilter(storageConfig.usernameFilterCapacity);
+    }
+
+    // 后台把旧模式版本的记录改写为当前格式，与请求处理并行
+    if (storageConfig.convertRecordsPerSec > 0) {
+        recordConverter.reset(new RecordConverter(*storage, transactionManager, depositManager,
+            storageConfig.convertRecordsPerSec));
+        recordConverter->start();
+        std::cout << "Record converter started: " << storageConfig.convertRecordsPerSec << " records/s" << std::endl;
+    }
     return true;
 }
 
 void BankingApp::run() {
-    // 初始化Redis连接
-    if (!initRedis()) {
-        std::cerr << "Failed to initialize Redis connections" << std::endl;
+    // 初始化存储后端
+    if (!initStorage()) {
+        std::cerr << "Failed to initialize storage backend" << std::endl;
         return;
     }
     
@@ -57,5 +115,19 @@ void BankingApp::run() {
 void BankingApp::stop() {
     // 停止HTTP服务器
     httpServer.stop();
+    // 转换线程经由分片修改存款记录，先于分片停止
+    if (recordConverter) {
+        recordConverter->stop();
+    }
+    if (accountShards) {
+        accountManager.setShards(nullptr);
+        accountShards->stop();
+    }
+    if (accountTable) {
+        accountTable->flush();
+    }
+    if (embeddedRedis) {
+        embeddedRedis->stop();
+    }
     std::cout << "Banking application stopped" << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,114 @@
+// BloomFilter.cpp - Implementation of the counting Bloom filter
+#include "BloomFilter.h"
+#include <cmath>
+
+namespace {
+
+const unsigned COUNTER_MAX = 15;
+const unsigned MAX_HASHES = 16;
+
+} // namespace
+
+CountingBloomFilter::CountingBloomFilter(size_t expectedItems, double falsePositiveRate)
+    : slots(0), hashes(1), capacity(expectedItems), items(0), ready(false) {
+    if (expectedItems < 1) {
+        expectedItems = 1;
+    }
+    if (falsePositiveRate <= 0 || falsePositiveRate >= 1) {
+        falsePositiveRate = 0.01;
+    }
+
+    // m = -n*ln(p)/ln(2)^2, k = m/n*ln(2)
+    const double ln2 = std::log(2.0);
+    double m = std::ceil(-static_cast<double>(expectedItems) * std::log(falsePositiveRate) / (ln2 * ln2));
+    slots = static_cast<size_t>(m) < 64 ? 64 : static_cast<size_t>(m);
+    double k = std::round(static_cast<double>(slots) / expectedItems * ln2);
+    hashes = k < 1 ? 1 : (k > MAX_HASHES ? MAX_HASHES : static_cast<unsigned>(k));
+    counters.assign((slots + 1) / 2, 0);
+}
+
+void CountingBloomFilter::hashPair(const std::string& item, uint64_t& h1, uint64_t& h2) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : item) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    h1 = hash;
+
+    // 第二个哈希由第一个混合得到（splitmix64终结器），保证为奇数
+    uint64_t z = hash + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    h2 = (z ^ (z >> 31)) | 1;
+}
+
+unsigned CountingBloomFilter::counter(size_t slot) const {
+    uint8_t byte = __atomic_load_n(&counters[slot / 2], __ATOMIC_RELAXED);
+    return (slot & 1) ? (byte >> 4) : (byte & 0x0f);
+}
+
+void CountingBloomFilter::increment(size_t slot) {
+    uint8_t* byte = &counters[slot / 2];
+    unsigned shift = (slot & 1) ? 4 : 0;
+    uint8_t current = __atomic_load_n(byte, __ATOMIC_RELAXED);
+    while (true) {
+        if (((current >> shift) & 0x0f) == COUNTER_MAX) {
+            return;   // 饱和
+        }
+        uint8_t next = static_cast<uint8_t>(current + (1u << shift));
+        if (__atomic_compare_exchange_n(byte, &current, next, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+}
+
+void CountingBloomFilter::decrement(size_t slot) {
+    uint8_t* byte = &counters[slot / 2];
+    unsigned shift = (slot & 1) ? 4 : 0;
+    uint8_t current = __atomic_load_n(byte, __ATOMIC_RELAXED);
+    while (true) {
+        unsigned value = (current >> shift) & 0x0f;
+        if (value == 0 || value == COUNTER_MAX) {
+            return;   // 饱和的计数器无法得知真实计数，保持不变
+        }
+        uint8_t next = static_cast<uint8_t>(current - (1u << shift));
+        if (__atomic_compare_exchange_n(byte, &current, next, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+}
+
+void CountingBloomFilter::add(const std::string& item) {
+    uint64_t h1 = 0;
+    uint64_t h2 = 0;
+    hashPair(item, h1, h2);
+    for (unsigned i = 0; i < hashes; i++) {
+        increment(static_cast<size_t>((h1 + i * h2) % slots));
+    }
+    items++;
+}
+
+void CountingBloomFilter::remove(const std::string& item) {
+    if (!mightContain(item)) {
+        return;
+    }
+    uint64_t h1 = 0;
+    uint64_t h2 = 0;
+    hashPair(item, h1, h2);
+    for (unsigned i = 0; i < hashes; i++) {
+        decrement(static_cast<size_t>((h1 + i * h2) % slots));
+    }
+    items--;
+}
+
+bool CountingBloomFilter::mightContain(const std::string& item) const {
+    uint64_t h1 = 0;
+    uint64_t h2 = 0;
+    hashPair(item, h1, h2);
+    for (unsigned i = 0; i < hashes; i++) {
+        if (counter(static_cast<size_t>((h1 + i * h2) % slots)) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -1,20 +1,27 @@
-// DepositManager.cpp - Implementation of deposit management functions with Redis
+// DepositManager.cpp - Implementation of deposit management functions
 #include "DepositManager.h"
 #include "Serializer.h"
 #include <iostream>
 #include <algorithm>
+#include <cstdlib>
 
-// Redis key prefixes
+// Storage key prefixes
 const std::string USER_DEPOSIT_COUNTER_KEY_PREFIX = "user:deposit_counter:";
-const std::string USER_DEPOSITS_KEY_PREFIX = "user:deposits:";
-const std::string DEPOSIT_KEY_PREFIX = "deposit:";
+const std::string USER_DEPOSIT_RECORDS_KEY_PREFIX = "user:deposit_records:"; // 用户全部存款（哈希表：存款ID -> 存款记录）
 
-DepositManager::DepositManager(AccountManager& am) 
-    : accountManager(am), redis("localhost", 6379) {
-}
+// 旧版布局，仅在迁移时读取
+const std::string USER_DEPOSITS_KEY_PREFIX = "user:deposits:";       // 存款ID列表
+const std::string USER_DEPOSIT_IDS_KEY_PREFIX = "user:deposit_ids:"; // 存款ID集合（哈希表）
+const std::string DEPOSIT_KEY_PREFIX = "deposit:";                   // 单条存款记录
+
+// 利率以万分之一为单位，利息 = 金额 * 利率 * 时长 / RATE_SCALE
+const int64_t RATE_SCALE = 10000;
 
-bool DepositManager::connect() {
-    return redis.connect();
+// 定期存款的最低金额（不含）：10000元
+const Money TIME_DEPOSIT_MINIMUM = 10000 * MoneyUtil::UNITS_PER_MAJOR;
+
+DepositManager::DepositManager(AccountManager& am, StorageBackend& storage, RecordFormat recordFormat)
+    : accountManager(am), storage(storage), recordFormat(recordFormat) {
 }
 
 std::string DepositManager::getUserDepositCounterKey(const std::string& username) {
@@ -25,73 +32,62 @@ std::string DepositManager::getUserDepositsKey(const std::string& username) {
     return USER_DEPOSITS_KEY_PREFIX + username;
 }
 
+std::string DepositManager::getUserDepositIdsKey(const std::string& username) {
+    return USER_DEPOSIT_IDS_KEY_PREFIX + username;
+}
+
+std::string DepositManager::getUserDepositRecordsKey(const std::string& username) {
+    return USER_DEPOSIT_RECORDS_KEY_PREFIX + username;
+}
+
 std::string DepositManager::getDepositKey(const std::string& username, const std::string& deposit_id) {
     return DEPOSIT_KEY_PREFIX + username + ":" + deposit_id;
 }
 
 std::string DepositManager::generateNextDepositId(const std::string& username) {
-    std::lock_guard<std::mutex> lock(counterMutex);
-    
-    // 获取用户的存款计数器
-    std::string counterKey = getUserDepositCounterKey(username);
-    std::string counterStr = redis.get(counterKey);
-    
-    int counter = 1;
-    if (!counterStr.empty()) {
-        counter = std::stoi(counterStr) + 1;
+    // 存储端原子自增，一次往返完成分配，多实例之间也不会重复
+    long long counter = 0;
+    if (!storage.incr(getUserDepositCounterKey(username), counter)) {
+        std::cerr << "无法分配存款ID: " << username << std::endl;
+        return "";
     }
     
-    // 更新计数器
-    redis.set(counterKey, std::to_string(counter));
-    
     // 生成格式为 "username-sequence" 的存款ID
     return username + "-" + std::to_string(counter);
 }
 
-bool DepositManager::createDeposit(const std::string& username, double amount, int deposit_type, int deposit_term) {
-    User* user = accountManager.getUser(username);
-    if (!user) {
-        return false;
-    }
+TransactionResult DepositManager::createDeposit(const std::string& username, Money amount, int deposit_type, int deposit_term) {
+    TransactionResult result;
 
     // 验证参数
     if (deposit_type == DEMAND_DEPOSIT) {
         if (amount <= 0) {
-            delete user;
-            return false;
+            return result;
         }
     }
     else if (deposit_type == TIME_DEPOSIT) {
-        // 定期存款最低金额为10000
-        if (amount <= 10000 || (deposit_term != TWO_MINUTES && deposit_term != THREE_MINUTES && deposit_term != FIVE_MINUTES)) {
-            delete user;
-            return false;
+        // 定期存款金额须超过10000元
+        if (amount <= TIME_DEPOSIT_MINIMUM || (deposit_term != TWO_MINUTES && deposit_term != THREE_MINUTES && deposit_term != FIVE_MINUTES)) {
+            return result;
         }
     }
     else {
-        delete user;
-        return false;
+        return result;
     }
 
-    // 检查余额是否充足
-    if (user->balance < amount) {
-        delete user;
-        return false;
+    // 先分配存款ID，失败时不扣款（扣款失败只会在ID序列中留下空号）
+    std::string depositId = generateNextDepositId(username);
+    if (depositId.empty()) {
+        return result;
     }
 
-    // 从余额中扣除金额
-    user->balance -= amount;
-
-    // 更新用户余额
-    bool userUpdated = accountManager.updateUser(*user);
+    // 检查余额是否充足并扣除金额（余额不足时不做任何修改）
+    Money balance = 0;
+    bool userUpdated = accountManager.adjustBalance(username, -amount, balance);
     if (!userUpdated) {
-        delete user;
-        return false;
+        return result;
     }
 
-    // 生成唯一的存款ID
-    std::string depositId = generateNextDepositId(username);
-
     // 创建新存款
     Deposit new_deposit;
     new_deposit.id = depositId;
@@ -103,26 +99,27 @@ bool DepositManager::createDeposit(const std::string& username, double amount, i
     new_deposit.isMatured = false;
 
     // 序列化存款信息
-    std::string serialized = Serializer::serializeDeposit(new_deposit);
-    
-    // 存储存款信息到Redis
-    bool depositStored = redis.set(getDepositKey(username, depositId), serialized);
+    std::string serialized = Serializer::serializeDeposit(new_deposit, recordFormat);
     
-    // 将存款ID添加到用户的存款列表
-    bool idAdded = redis.rpush(getUserDepositsKey(username), depositId);
+    // 存款记录写入用户的存款哈希表（一次写入）
+    bool depositStored = storage.hset(getUserDepositRecordsKey(username), depositId, serialized);
     
-    delete user;
-    return depositStored && idAdded;
+    result.balance = balance;
+    result.depositId = depositId;
+
+    // 等待本次修改持久化后再返回
+    result.success = depositStored && storage.sync();
+    return result;
 }
 
-double DepositManager::calculateInterest(const Deposit& deposit, int seconds) {
-    double interest_rate = 0.0;
-    double total_interest = 0.0;
+Money DepositManager::calculateInterest(const Deposit& deposit, int seconds) {
+    int64_t interest_rate = 0;
+    Money total_interest = 0;
 
     if (deposit.type == DEMAND_DEPOSIT) {
         // 活期存款利率：每秒0.03%
-        interest_rate = 0.0003;
-        total_interest = deposit.amount * interest_rate * seconds;
+        interest_rate = 3;
+        total_interest = MoneyUtil::scale(deposit.amount, interest_rate * seconds, RATE_SCALE);
     }
     else if (deposit.type == TIME_DEPOSIT) {
         // 计算定期存款利息
@@ -131,47 +128,82 @@ double DepositManager::calculateInterest(const Deposit& deposit, int seconds) {
         switch (deposit.term) {
         case TWO_MINUTES:
             // 2分钟期限：每分钟0.07%
-            interest_rate = 0.0007;
+            interest_rate = 7;
             break;
         case THREE_MINUTES:
             // 3分钟期限：每分钟0.09%
-            interest_rate = 0.0009;
+            interest_rate = 9;
             break;
         case FIVE_MINUTES:
             // 5分钟期限：每分钟0.1%
-            interest_rate = 0.001;
+            interest_rate = 10;
             break;
         default:
-            return 0.0;
+            return 0;
         }
 
-        total_interest = deposit.amount * interest_rate * minutes;
+        total_interest = MoneyUtil::scale(deposit.amount, interest_rate * minutes, RATE_SCALE);
     }
 
     return total_interest;
 }
 
 std::vector<Deposit> DepositManager::getUserDeposits(const std::string& username) {
-    std::vector<Deposit> deposits;
-    
-    // 获取用户的所有存款ID
-    std::vector<std::string> depositIds = redis.lrange(getUserDepositsKey(username), 0, -1);
-    
-    // 获取每个存款的详细信息
-    for (const auto& depositId : depositIds) {
-        std::string serialized = redis.get(getDepositKey(username, depositId));
-        if (!serialized.empty()) {
-            Deposit deposit = Serializer::deserializeDeposit(serialized);
-            deposits.push_back(deposit);
+    // 一次HGETALL取得全部存款
+    std::map<std::string, std::string> records = storage.hgetall(getUserDepositRecordsKey(username));
+
+    std::vector<Deposit> deposits(records.size());
+    size_t count = 0;
+    bool stale = false;
+    for (const auto& entry : records) {
+        if (Serializer::deserializeDeposit(entry.second.data(), entry.second.size(), deposits[count])) {
+            stale = stale || Serializer::needsUpgrade(entry.second.data(), entry.second.size(), recordFormat);
+            count++;
         }
+        else {
+            std::cerr << "无法解析存款记录: " << entry.first << std::endl;
+        }
+    }
+    deposits.resize(count);
+
+    // 存款记录可被取款修改，不能直接写回本次读到的内容
+    if (stale) {
+        upgradeDeposits(username);
     }
+
+    // 按创建顺序（ID末尾的序号）排列
+    std::sort(deposits.begin(), deposits.end(), [](const Deposit& a, const Deposit& b) {
+        unsigned long long sa = depositSequence(a.id);
+        unsigned long long sb = depositSequence(b.id);
+        return sa != sb ? sa < sb : a.id < b.id;
+    });
     
     return deposits;
 }
 
+size_t DepositManager::upgradeDeposits(const std::string& username) {
+    size_t upgraded = 0;
+    // 本进程的取款在同一存款条带锁内修改存款记录；其他实例可能在读取与改写之间取款，
+    // 所以只在存储中的记录仍是读到的旧值时才改写，否则跳过（已取出的存款不会被写回）
+    LockStripes::Guard guard(depositLocks, username);
+    const std::string key = getUserDepositRecordsKey(username);
+    std::map<std::string, std::string> records = storage.hgetall(key);
+    Deposit deposit;
+    for (const auto& entry : records) {
+        if (!Serializer::needsUpgrade(entry.second.data(), entry.second.size(), recordFormat) ||
+            !Serializer::deserializeDeposit(entry.second.data(), entry.second.size(), deposit)) {
+            continue;
+        }
+        if (storage.hsetIfEqual(key, entry.first, entry.second, Serializer::serializeDeposit(deposit, recordFormat))) {
+            upgraded++;
+        }
+    }
+    return upgraded;
+}
+
 Deposit DepositManager::getDepositDetails(const std::string& username, const std::string& deposit_id) {
-    // 从Redis获取存款信息
-    std::string serialized = redis.get(getDepositKey(username, deposit_id));
+    // 从存储获取存款信息
+    std::string serialized = storage.hget(getUserDepositRecordsKey(username), deposit_id);
     
     if (!serialized.empty()) {
         return Serializer::deserializeDeposit(serialized);
@@ -182,84 +214,92 @@ Deposit DepositManager::getDepositDetails(const std::string& username, const std
     return Deposit();
 }
 
-// 从用户的存款列表中删除指定存款ID
-bool DepositManager::removeDepositFromUserList(const std::string& username, const std::string& deposit_id) {
-    // 获取用户所有存款ID
-    std::vector<std::string> depositIds = redis.lrange(getUserDepositsKey(username), 0, -1);
-    
-    // 从Redis中删除整个列表
-    redis.del(getUserDepositsKey(username));
-    
-    // 创建一个新列表，不包含要删除的ID
-    bool found = false;
-    for (const auto& id : depositIds) {
-        if (id != deposit_id) {
-            redis.rpush(getUserDepositsKey(username), id);
-        } else {
-            found = true;
-        }
+unsigned long long DepositManager::depositSequence(const std::string& deposit_id) {
+    size_t dash = deposit_id.rfind('-');
+    if (dash == std::string::npos) {
+        return 0;
     }
-    
-    return found;
+    return std::strtoull(deposit_id.c_str() + dash + 1, nullptr, 10);
 }
 
-bool DepositManager::withdrawDeposit(const std::string& username, const std::string& deposit_id, double amount) {
-    User* user = accountManager.getUser(username);
-    if (!user) {
-        return false;
+bool DepositManager::migrateDepositLayout() {
+    // 旧版本每条存款单独存放在deposit:<用户>:<ID>，存款ID另存于列表（更早）或哈希表中；
+    // 逐个用户把存款记录并入user:deposit_records:<用户>，然后删除旧键。
+    // 可重复执行：已转换的用户没有旧键，直接跳过
+    std::vector<std::string> usernames = storage.lrange(AccountManager::getUsersListKey(), 0, -1);
+    size_t migrated = 0;
+    for (const auto& username : usernames) {
+        std::vector<std::string> depositIds = storage.lrange(getUserDepositsKey(username), 0, -1);
+        std::map<std::string, std::string> idSet = storage.hgetall(getUserDepositIdsKey(username));
+        for (const auto& entry : idSet) {
+            depositIds.push_back(entry.first);
+        }
+        if (depositIds.empty()) {
+            continue;
+        }
+
+        for (const auto& depositId : depositIds) {
+            std::string serialized = storage.get(getDepositKey(username, depositId));
+            if (serialized.empty()) {
+                continue;
+            }
+            if (!storage.hset(getUserDepositRecordsKey(username), depositId, serialized)) {
+                std::cerr << "存款记录迁移失败: " << username << std::endl;
+                return false;
+            }
+            storage.del(getDepositKey(username, depositId));
+        }
+        storage.del(getUserDepositsKey(username));
+        storage.del(getUserDepositIdsKey(username));
+        migrated++;
+    }
+    if (migrated > 0) {
+        std::cout << "Migrated deposits of " << migrated << " users to the per-user hash layout" << std::endl;
     }
+    return storage.sync();
+}
 
+bool DepositManager::settleWithdrawal(const std::string& username, const std::string& deposit_id, Money amount, Money& credited,
+                                      std::string& previous) {
     // 获取存款详情
-    std::string serialized = redis.get(getDepositKey(username, deposit_id));
+    std::string serialized = storage.hget(getUserDepositRecordsKey(username), deposit_id);
     if (serialized.empty()) {
-        delete user;
         return false; // 未找到指定存款
     }
+    previous = serialized;
     
     Deposit deposit = Serializer::deserializeDeposit(serialized);
 
     // 验证取款金额
     if (amount <= 0 || amount > deposit.amount) {
-        delete user;
         return false;
     }
 
     // 检查是否允许取款
     time_t current_time = time(nullptr);
     time_t elapsed_seconds = current_time - deposit.depositTime;
-    double actual_amount = 0.0; // 实际取出金额（含利息）
+    Money actual_amount = 0; // 实际取出金额（含利息）
 
     if (deposit.type == DEMAND_DEPOSIT) {
         // 活期存款：利息 = 本金 * 利率 * 秒数
-        double interest_rate = 0.0003; // 0.03%
+        int64_t interest_rate = 3; // 0.03%
 
-        // 计算按比例的利息
-        double proportion = amount / deposit.amount;
-        double interest = deposit.amount * interest_rate * elapsed_seconds * proportion;
+        // 只对取出的部分计息
+        Money interest = MoneyUtil::scale(amount, interest_rate * elapsed_seconds, RATE_SCALE);
         actual_amount = amount + interest;
 
-        // 更新用户余额
-        user->balance += actual_amount;
+        // 计入用户余额的金额
+        credited = actual_amount;
 
-        // 更新存款金额
+        // 更新存款金额，写入失败时不入账
         if (amount >= deposit.amount) {
             // 如果取出全部金额，删除该存款
-            redis.del(getDepositKey(username, deposit_id));
-            
-            // 从用户的存款列表中移除此存款ID
-            removeDepositFromUserList(username, deposit_id);
+            return storage.hdel(getUserDepositRecordsKey(username), deposit_id);
         }
-        else {
-            // 否则只减少存款金额
-            deposit.amount -= amount;
-            std::string updatedSerialized = Serializer::serializeDeposit(deposit);
-            redis.set(getDepositKey(username, deposit_id), updatedSerialized);
-        }
-
-        // 更新用户信息
-        bool updated = accountManager.updateUser(*user);
-        delete user;
-        return updated;
+        // 否则只减少存款金额
+        deposit.amount -= amount;
+        std::string updatedSerialized = Serializer::serializeDeposit(deposit, recordFormat);
+        return storage.hset(getUserDepositRecordsKey(username), deposit_id, updatedSerialized);
     }
     else if (deposit.type == TIME_DEPOSIT) {
         // 定期存款：检查是否到期
@@ -267,59 +307,71 @@ bool DepositManager::withdrawDeposit(const std::string& username, const std::str
 
         if (elapsed_seconds < term_seconds) {
             // 未到期，不允许取款
-            delete user;
             return false;
         }
 
         // 已到期，计算利息
-        double interest_rate = 0.0;
+        int64_t interest_rate = 0;
         switch (deposit.term) {
         case TWO_MINUTES:
-            interest_rate = 0.0007; // 0.07%
+            interest_rate = 7; // 0.07%
             break;
         case THREE_MINUTES:
-            interest_rate = 0.0009; // 0.09%
+            interest_rate = 9; // 0.09%
             break;
         case FIVE_MINUTES:
-            interest_rate = 0.001; // 0.1%
+            interest_rate = 10; // 0.1%
             break;
         default:
-            delete user;
             return false;
         }
 
         // 计算已过的完整分钟数
         int elapsed_minutes = elapsed_seconds / 60;
 
-        // 计算按比例的利息
-        double proportion = amount / deposit.amount;
-        double interest = deposit.amount * interest_rate * elapsed_minutes * proportion;
+        // 只对取出的部分计息
+        Money interest = MoneyUtil::scale(amount, interest_rate * elapsed_minutes, RATE_SCALE);
         actual_amount = amount + interest;
 
-        // 更新用户余额
-        user->balance += actual_amount;
+        // 计入用户余额的金额
+        credited = actual_amount;
 
-        // 更新存款金额
+        // 更新存款金额，写入失败时不入账
         if (amount >= deposit.amount) {
             // 如果取出全部金额，删除该存款
-            redis.del(getDepositKey(username, deposit_id));
-            
-            // 从用户的存款列表中移除此存款ID
-            removeDepositFromUserList(username, deposit_id);
-        }
-        else {
-            // 否则只减少存款金额
-            deposit.amount -= amount;
-            std::string updatedSerialized = Serializer::serializeDeposit(deposit);
-            redis.set(getDepositKey(username, deposit_id), updatedSerialized);
+            return storage.hdel(getUserDepositRecordsKey(username), deposit_id);
         }
+        // 否则只减少存款金额
+        deposit.amount -= amount;
+        std::string updatedSerialized = Serializer::serializeDeposit(deposit, recordFormat);
+        return storage.hset(getUserDepositRecordsKey(username), deposit_id, updatedSerialized);
+    }
+
+    return false; // 存款类型错误
+}
 
-        // 更新用户信息
-        bool updated = accountManager.updateUser(*user);
-        delete user;
-        return updated;
+TransactionResult DepositManager::withdrawDeposit(const std::string& username, const std::string& deposit_id, Money amount) {
+    TransactionResult result;
+    result.depositId = deposit_id;
+
+    // 先在存款条带锁内结算存款记录，再把本息原子地计入余额（与存取款一样不读-改-写整个账户），
+    // 入账失败时恢复原记录，取出的金额不会丢失
+    LockStripes::Guard guard(depositLocks, username);
+    Money credited = 0;
+    std::string previous;
+    if (!settleWithdrawal(username, deposit_id, amount, credited, previous)) {
+        return result;
+    }
+
+    Money balance = 0;
+    if (!accountManager.adjustBalance(username, credited, balance)) {
+        if (!storage.hset(getUserDepositRecordsKey(username), deposit_id, previous)) {
+            std::cerr << "恢复存款记录失败: " << deposit_id << std::endl;
+        }
+        return result;
     }
 
-    delete user;
-    return false; // 未找到指定存款或存款类型错误
+    result.balance = balance;
+    result.success = storage.sync();
+    return result;
 }
\ No newline at end of file
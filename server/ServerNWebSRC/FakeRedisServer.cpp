@@ -0,0 +1,681 @@
+// FakeRedisServer.cpp - RESP protocol handling and command execution for the fake Redis
+#include "FakeRedisServer.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <cctype>
+#include <climits>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+namespace {
+
+const int LISTEN_BACKLOG = 128;
+const long long MAX_ARGS = 1024 * 1024;
+const long long MAX_BULK_LENGTH = 512LL * 1024 * 1024;
+const size_t MAX_INLINE_LENGTH = 64 * 1024;
+
+const char WRONGTYPE_ERROR[] = "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n";
+const char NOT_INTEGER_ERROR[] = "-ERR value is not an integer or out of range\r\n";
+
+// 命令参数个数（含命令名），负数表示至少|arity|个
+struct CommandSpec {
+    const char* name;
+    int arity;
+};
+
+const CommandSpec COMMANDS[] = {
+    { "PING", -1 }, { "AUTH", 2 }, { "SELECT", 2 }, { "QUIT", 1 },
+    { "GET", 2 }, { "SET", 3 }, { "EXISTS", -2 }, { "DEL", -2 }, { "TYPE", 2 },
+    { "INCR", 2 },
+    { "EXPIRE", 3 }, { "TTL", 2 },
+    { "HSET", -4 }, { "HGET", 3 }, { "HEXISTS", 3 }, { "HDEL", -3 }, { "HGETALL", 2 }, { "HLEN", 2 },
+    { "HINCRBY", 4 }, { "EVAL", -3 },
+    { "LPUSH", -3 }, { "RPUSH", -3 }, { "LRANGE", 4 }, { "LLEN", 2 }, { "LSET", 4 },
+    { "MULTI", 1 }, { "EXEC", 1 }, { "DISCARD", 1 },
+    { "FLUSHDB", 1 }, { "FLUSHALL", 1 }
+};
+
+std::string simpleReply(const std::string& s) {
+    return "+" + s + "\r\n";
+}
+
+std::string errorReply(const std::string& s) {
+    return "-" + s + "\r\n";
+}
+
+std::string integerReply(long long n) {
+    return ":" + std::to_string(n) + "\r\n";
+}
+
+std::string bulkReply(const std::string& s) {
+    return "$" + std::to_string(s.size()) + "\r\n" + s + "\r\n";
+}
+
+std::string nilReply() {
+    return "$-1\r\n";
+}
+
+std::string arrayHeader(size_t n) {
+    return "*" + std::to_string(n) + "\r\n";
+}
+
+bool parseInteger(const std::string& s, long long& value) {
+    if (s.empty()) {
+        return false;
+    }
+    errno = 0;
+    char* end = nullptr;
+    value = std::strtoll(s.c_str(), &end, 10);
+    return errno == 0 && end == s.c_str() + s.size();
+}
+
+bool sendAll(int fd, const std::string& data) {
+    const char* p = data.data();
+    size_t len = data.size();
+    while (len > 0) {
+        ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+FakeRedisServer::FakeRedisServer(int port, const std::string& password, unsigned latencyUs)
+    : port(port), password(password), latencyUs(latencyUs), serverFd(-1), running(false) {
+}
+
+FakeRedisServer::~FakeRedisServer() {
+    stop();
+}
+
+bool FakeRedisServer::start() {
+    serverFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (serverFd < 0) {
+        std::cerr << "Fake Redis socket creation failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    int opt = 1;
+    setsockopt(serverFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    // 只监听本机，避免无密码的测试实例暴露到网络
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+
+    if (::bind(serverFd, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+        ::listen(serverFd, LISTEN_BACKLOG) < 0) {
+        std::cerr << "Fake Redis bind/listen on port " << port << " failed: " << strerror(errno) << std::endl;
+        ::close(serverFd);
+        serverFd = -1;
+        return false;
+    }
+
+    socklen_t addrlen = sizeof(address);
+    if (::getsockname(serverFd, (struct sockaddr*)&address, &addrlen) == 0) {
+        port = ntohs(address.sin_port);
+    }
+
+    running = true;
+    acceptThread = std::thread(&FakeRedisServer::acceptLoop, this);
+    std::cout << "Fake Redis listening on 127.0.0.1:" << port;
+    if (latencyUs > 0) {
+        std::cout << " (latency " << latencyUs << "us)";
+    }
+    std::cout << std::endl;
+    return true;
+}
+
+void FakeRedisServer::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+
+    // shutdown可以唤醒阻塞在accept上的线程
+    ::shutdown(serverFd, SHUT_RDWR);
+    ::close(serverFd);
+    serverFd = -1;
+    if (acceptThread.joinable()) {
+        acceptThread.join();
+    }
+
+    std::vector<std::thread> finished;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        for (int fd : clientFds) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+        finished.swap(clients);
+        finishedClients.clear();
+    }
+    for (auto& thread : finished) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+int FakeRedisServer::getPort() const {
+    return port;
+}
+
+void FakeRedisServer::setLatency(unsigned us) {
+    latencyUs = us;
+}
+
+void FakeRedisServer::acceptLoop() {
+    while (running) {
+        int clientFd = ::accept(serverFd, nullptr, nullptr);
+        if (clientFd < 0) {
+            if (!running) {
+                break;
+            }
+            if (errno != EINTR) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            continue;
+        }
+
+        int opt = 1;
+        setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+
+        // 每次接受新连接时回收已关闭连接的线程，避免线程对象随连接数累积
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        reapClients();
+        clientFds.insert(clientFd);
+        clients.push_back(std::thread(&FakeRedisServer::handleClient, this, clientFd));
+    }
+}
+
+void FakeRedisServer::reapClients() {
+    for (auto it = clients.begin(); it != clients.end();) {
+        auto finished = finishedClients.find(it->get_id());
+        if (finished == finishedClients.end()) {
+            ++it;
+            continue;
+        }
+        // 线程登记后只剩释放锁并返回，join不会长时间阻塞
+        finishedClients.erase(finished);
+        it->join();
+        it = clients.erase(it);
+    }
+}
+
+void FakeRedisServer::handleClient(int clientFd) {
+    Session session;
+    std::string buffer;
+    char chunk[16384];
+    bool quit = false;
+
+    while (!quit) {
+        ssize_t n = ::recv(clientFd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        buffer.append(chunk, static_cast<size_t>(n));
+
+        // 处理缓冲区中所有完整的命令（支持流水线）
+        std::string out;
+        size_t pos = 0;
+        std::vector<std::string> args;
+        while (true) {
+            bool error = false;
+            if (!parseCommand(buffer, pos, args, error)) {
+                if (error) {
+                    out += errorReply("ERR Protocol error");
+                    quit = true;
+                }
+                break;
+            }
+            if (args.empty()) {
+                continue;
+            }
+            for (auto& c : args[0]) {
+                c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+            }
+            out += dispatch(session, args);
+            if (args[0] == "QUIT") {
+                quit = true;
+                break;
+            }
+        }
+        buffer.erase(0, pos);
+
+        if (!out.empty()) {
+            unsigned delay = latencyUs;
+            if (delay > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(delay));
+            }
+            if (!sendAll(clientFd, out)) {
+                break;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    clientFds.erase(clientFd);
+    finishedClients.insert(std::this_thread::get_id());
+    ::close(clientFd);
+}
+
+bool FakeRedisServer::parseCommand(const std::string& buffer, size_t& pos, std::vector<std::string>& args, bool& error) {
+    args.clear();
+    if (pos >= buffer.size()) {
+        return false;
+    }
+
+    if (buffer[pos] != '*') {
+        // 内联命令（telnet/redis-cli调试用）
+        size_t newline = buffer.find('\n', pos);
+        if (newline == std::string::npos) {
+            error = buffer.size() - pos > MAX_INLINE_LENGTH;
+            return false;
+        }
+        size_t end = newline;
+        if (end > pos && buffer[end - 1] == '\r') {
+            end--;
+        }
+        size_t i = pos;
+        while (i < end) {
+            while (i < end && buffer[i] == ' ') {
+                i++;
+            }
+            size_t start = i;
+            while (i < end && buffer[i] != ' ') {
+                i++;
+            }
+            if (i > start) {
+                args.push_back(buffer.substr(start, i - start));
+            }
+        }
+        pos = newline + 1;
+        return true;
+    }
+
+    // RESP数组: *<n>\r\n 后跟n个 $<len>\r\n<data>\r\n
+    size_t crlf = buffer.find("\r\n", pos);
+    if (crlf == std::string::npos) {
+        return false;
+    }
+    long long count = 0;
+    if (!parseInteger(buffer.substr(pos + 1, crlf - pos - 1), count) || count < 0 || count > MAX_ARGS) {
+        error = true;
+        return false;
+    }
+
+    size_t p = crlf + 2;
+    for (long long i = 0; i < count; i++) {
+        if (p >= buffer.size()) {
+            return false;
+        }
+        if (buffer[p] != '$') {
+            error = true;
+            return false;
+        }
+        crlf = buffer.find("\r\n", p);
+        if (crlf == std::string::npos) {
+            return false;
+        }
+        long long len = 0;
+        if (!parseInteger(buffer.substr(p + 1, crlf - p - 1), len) || len < 0 || len > MAX_BULK_LENGTH) {
+            error = true;
+            return false;
+        }
+        p = crlf + 2;
+        if (buffer.size() - p < static_cast<size_t>(len) + 2) {
+            return false;
+        }
+        args.push_back(buffer.substr(p, static_cast<size_t>(len)));
+        p += static_cast<size_t>(len) + 2;
+    }
+    pos = p;
+    return true;
+}
+
+std::string FakeRedisServer::checkCommand(const std::vector<std::string>& args) {
+    for (const auto& spec : COMMANDS) {
+        if (args[0] != spec.name) {
+            continue;
+        }
+        int argc = static_cast<int>(args.size());
+        bool ok = spec.arity > 0 ? argc == spec.arity : argc >= -spec.arity;
+        if (ok && args[0] == "HSET") {
+            ok = argc % 2 == 0;   // 字段和值成对出现
+        }
+        if (!ok) {
+            std::string name = args[0];
+            for (auto& c : name) {
+                c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+            }
+            return errorReply("ERR wrong number of arguments for '" + name + "' command");
+        }
+        return "";
+    }
+    return errorReply("ERR unknown command '" + args[0] + "'");
+}
+
+std::string FakeRedisServer::dispatch(Session& session, const std::vector<std::string>& args) {
+    std::string error = checkCommand(args);
+    if (!error.empty()) {
+        if (session.inMulti) {
+            session.multiError = true;
+        }
+        return error;
+    }
+
+    const std::string& cmd = args[0];
+    if (cmd == "QUIT") {
+        return simpleReply("OK");
+    }
+    if (cmd == "AUTH") {
+        if (password.empty()) {
+            return errorReply("ERR Client sent AUTH, but no password is set");
+        }
+        if (args[1] != password) {
+            return errorReply("WRONGPASS invalid username-password pair");
+        }
+        session.authenticated = true;
+        return simpleReply("OK");
+    }
+    if (!password.empty() && !session.authenticated) {
+        return errorReply("NOAUTH Authentication required.");
+    }
+
+    if (cmd == "MULTI") {
+        if (session.inMulti) {
+            return errorReply("ERR MULTI calls can not be nested");
+        }
+        session.inMulti = true;
+        session.multiError = false;
+        session.queued.clear();
+        return simpleReply("OK");
+    }
+    if (cmd == "DISCARD") {
+        if (!session.inMulti) {
+            return errorReply("ERR DISCARD without MULTI");
+        }
+        session.inMulti = false;
+        session.queued.clear();
+        return simpleReply("OK");
+    }
+    if (cmd == "EXEC") {
+        if (!session.inMulti) {
+            return errorReply("ERR EXEC without MULTI");
+        }
+        session.inMulti = false;
+        if (session.multiError) {
+            session.queued.clear();
+            return errorReply("EXECABORT Transaction discarded because of previous errors.");
+        }
+
+        // 整个事务在一次加锁内执行
+        std::string reply = arrayHeader(session.queued.size());
+        {
+            std::lock_guard<std::mutex> lock(commandMutex);
+            for (const auto& queued : session.queued) {
+                reply += execute(queued);
+            }
+        }
+        session.queued.clear();
+        return reply;
+    }
+    if (session.inMulti) {
+        session.queued.push_back(args);
+        return simpleReply("QUEUED");
+    }
+
+    std::lock_guard<std::mutex> lock(commandMutex);
+    return execute(args);
+}
+
+void FakeRedisServer::expireIfNeeded(const std::string& key) {
+    auto it = expires.find(key);
+    if (it != expires.end() && Clock::now() >= it->second) {
+        store.del(key);
+        expires.erase(it);
+    }
+}
+
+std::string FakeRedisServer::execute(const std::vector<std::string>& args) {
+    const std::string& cmd = args[0];
+
+    if (cmd == "PING") {
+        return args.size() > 1 ? bulkReply(args[1]) : simpleReply("PONG");
+    }
+    if (cmd == "SELECT") {
+        return simpleReply("OK");
+    }
+    if (cmd == "FLUSHDB" || cmd == "FLUSHALL") {
+        store.clear();
+        expires.clear();
+        return simpleReply("OK");
+    }
+
+    for (size_t i = 1; i < args.size(); i++) {
+        expireIfNeeded(args[i]);
+    }
+
+    // 不解释Lua，只识别hincrbyIfAtLeast和hsetIfEqual使用的脚本
+    if (cmd == "EVAL") {
+        bool incrementScript = args[1] == HINCRBY_IF_AT_LEAST_SCRIPT;
+        if ((!incrementScript && args[1] != HSET_IF_EQUAL_SCRIPT) || args.size() != 7 || args[2] != "1") {
+            return errorReply("ERR only the conditional HINCRBY/HSET scripts are supported");
+        }
+        std::string hashType = store.type(args[3]);
+        if (hashType != "none" && hashType != "hash") {
+            return WRONGTYPE_ERROR;
+        }
+        if (!incrementScript) {
+            return integerReply(store.hsetIfEqual(args[3], args[4], args[5], args[6]) ? 1 : 0);
+        }
+        long long increment = 0;
+        long long minimum = 0;
+        long long value = 0;
+        if (!parseInteger(args[5], increment) || !parseInteger(args[6], minimum)) {
+            return NOT_INTEGER_ERROR;
+        }
+        return store.hincrbyIfAtLeast(args[3], args[4], increment, minimum, value) ? integerReply(value) : nilReply();
+    }
+    const std::string& key = args[1];
+    std::string type = store.type(key);
+
+    // 键存在但类型不符
+    auto wrongType = [&type](const char* expected) {
+        return type != "none" && type != expected;
+    };
+
+    if (cmd == "GET") {
+        if (type == "none") {
+            return nilReply();
+        }
+        if (wrongType("string")) {
+            return WRONGTYPE_ERROR;
+        }
+        return bulkReply(store.get(key));
+    }
+    if (cmd == "SET") {
+        store.set(key, args[2]);
+        expires.erase(key);
+        return simpleReply("OK");
+    }
+    if (cmd == "INCR") {
+        if (wrongType("string")) {
+            return WRONGTYPE_ERROR;
+        }
+        long long value = 0;
+        if (!store.incr(key, value)) {
+            return NOT_INTEGER_ERROR;
+        }
+        return integerReply(value);
+    }
+    if (cmd == "EXISTS" || cmd == "DEL") {
+        long long count = 0;
+        for (size_t i = 1; i < args.size(); i++) {
+            if (cmd == "DEL") {
+                if (store.del(args[i])) {
+                    count++;
+                }
+                expires.erase(args[i]);
+            }
+            else if (store.exists(args[i])) {
+                count++;
+            }
+        }
+        return integerReply(count);
+    }
+    if (cmd == "TYPE") {
+        return simpleReply(type);
+    }
+    if (cmd == "EXPIRE") {
+        long long seconds = 0;
+        if (!parseInteger(args[2], seconds)) {
+            return NOT_INTEGER_ERROR;
+        }
+        if (type == "none") {
+            return integerReply(0);
+        }
+        if (seconds <= 0) {
+            store.del(key);
+            expires.erase(key);
+        }
+        else {
+            expires[key] = Clock::now() + std::chrono::seconds(seconds);
+        }
+        return integerReply(1);
+    }
+    if (cmd == "TTL") {
+        if (type == "none") {
+            return integerReply(-2);
+        }
+        auto it = expires.find(key);
+        if (it == expires.end()) {
+            return integerReply(-1);
+        }
+        long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(it->second - Clock::now()).count();
+        return integerReply((ms + 500) / 1000);
+    }
+
+    if (cmd == "HSET") {
+        if (wrongType("hash")) {
+            return WRONGTYPE_ERROR;
+        }
+        long long added = 0;
+        for (size_t i = 2; i + 1 < args.size(); i += 2) {
+            if (!store.hexists(key, args[i])) {
+                added++;
+            }
+            store.hset(key, args[i], args[i + 1]);
+        }
+        return integerReply(added);
+    }
+    if (cmd == "HINCRBY") {
+        if (wrongType("hash")) {
+            return WRONGTYPE_ERROR;
+        }
+        long long increment = 0;
+        long long value = 0;
+        if (!parseInteger(args[3], increment) || !store.hincrby(key, args[2], increment, value)) {
+            return NOT_INTEGER_ERROR;
+        }
+        return integerReply(value);
+    }
+    if (cmd == "HGET" || cmd == "HEXISTS" || cmd == "HDEL" || cmd == "HGETALL" || cmd == "HLEN") {
+        if (wrongType("hash")) {
+            return WRONGTYPE_ERROR;
+        }
+        if (cmd == "HGET") {
+            return store.hexists(key, args[2]) ? bulkReply(store.hget(key, args[2])) : nilReply();
+        }
+        if (cmd == "HEXISTS") {
+            return integerReply(store.hexists(key, args[2]) ? 1 : 0);
+        }
+        if (cmd == "HDEL") {
+            long long removed = 0;
+            for (size_t i = 2; i < args.size(); i++) {
+                if (store.hdel(key, args[i])) {
+                    removed++;
+                }
+            }
+            // 哈希表被删空时一并清除过期时间
+            if (!store.exists(key)) {
+                expires.erase(key);
+            }
+            return integerReply(removed);
+        }
+        std::map<std::string, std::string> fields = store.hgetall(key);
+        if (cmd == "HLEN") {
+            return integerReply(static_cast<long long>(fields.size()));
+        }
+        std::string reply = arrayHeader(fields.size() * 2);
+        for (const auto& entry : fields) {
+            reply += bulkReply(entry.first);
+            reply += bulkReply(entry.second);
+        }
+        return reply;
+    }
+
+    if (wrongType("list")) {
+        return WRONGTYPE_ERROR;
+    }
+    if (cmd == "LPUSH" || cmd == "RPUSH") {
+        for (size_t i = 2; i < args.size(); i++) {
+            if (cmd == "LPUSH") {
+                store.lpush(key, args[i]);
+            }
+            else {
+                store.rpush(key, args[i]);
+            }
+        }
+        return integerReply(static_cast<long long>(store.llen(key)));
+    }
+    if (cmd == "LLEN") {
+        return integerReply(static_cast<long long>(store.llen(key)));
+    }
+    if (cmd == "LRANGE") {
+        long long start = 0;
+        long long stop = 0;
+        if (!parseInteger(args[2], start) || !parseInteger(args[3], stop) ||
+            start < INT_MIN || start > INT_MAX || stop < INT_MIN || stop > INT_MAX) {
+            return NOT_INTEGER_ERROR;
+        }
+        std::vector<std::string> items = store.lrange(key, static_cast<int>(start), static_cast<int>(stop));
+        std::string reply = arrayHeader(items.size());
+        for (const auto& item : items) {
+            reply += bulkReply(item);
+        }
+        return reply;
+    }
+    if (cmd == "LSET") {
+        long long index = 0;
+        if (!parseInteger(args[2], index) || index < INT_MIN || index > INT_MAX) {
+            return NOT_INTEGER_ERROR;
+        }
+        if (!store.exists(key)) {
+            return errorReply("ERR no such key");
+        }
+        if (!store.lset(key, static_cast<int>(index), args[3])) {
+            return errorReply("ERR index out of range");
+        }
+        return simpleReply("OK");
+    }
+
+    return errorReply("ERR unknown command '" + cmd + "'");
+}
@@ -1,8 +1,10 @@
 // HttpServer.cpp - Implementation of HTTP API server functionality (frontend functionality removed)
 #include "HttpServer.h"
+#include "JsonWriter.h"
 #include <iostream>
 #include <sstream>
 #include <cstring>
+#include <cstdlib>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -116,7 +118,7 @@ void HttpServer::handleClient(int client_socket) {
         }
         else {
             // 404 Not Found
-            sendResponse(client_socket, "application/json", "{\"status\":\"error\",\"message\":\"API endpoint not found\"}");
+            sendResponse(client_socket, "application/json", errorResponse("API endpoint not found"));
         }
     }
 
@@ -195,6 +197,45 @@ void HttpServer::sendResponse(int client_socket, const std::string& content_type
     send(client_socket, response.c_str(), response.length(), 0);
 }
 
+Money HttpServer::parseAmount(const std::string& text) {
+    Money amount = 0;
+    if (!MoneyUtil::parse(text, amount)) {
+        return 0;
+    }
+    return amount;
+}
+
+std::string HttpServer::errorResponse(const std::string& message) {
+    JsonWriter json(64 + message.size());
+    json.beginObject().key("status").string("error").key("message").string(message).endObject();
+    return json.release();
+}
+
+std::string HttpServer::balanceResponse(const char* message, const TransactionResult& result, const char* idKey,
+                                        const std::string& id) {
+    JsonWriter json(128);
+    json.beginObject()
+        .key("status").string("success")
+        .key("message").string(message)
+        .key("balance").money(result.balance);
+    if (idKey != nullptr) {
+        json.key(idKey).string(id);
+    }
+    json.endObject();
+    return json.release();
+}
+
+void HttpServer::writeDeposit(JsonWriter& json, const Deposit& deposit, time_t current_time) {
+    json.key("id").string(deposit.id)  // 使用字符串格式的ID
+        .key("amount").money(deposit.amount)
+        .key("type").integer(deposit.type);
+    if (deposit.type == TIME_DEPOSIT) {
+        json.key("term").integer(deposit.term);
+    }
+    json.key("depositTime").integer(deposit.depositTime)
+        .key("currentTime").integer(current_time);
+}
+
 void HttpServer::registerHandlers() {
     // Register POST handlers
     post_handlers["/api/register"] = [this](const std::map<std::string, std::string>& params) -> std::string {
@@ -205,10 +246,12 @@ void HttpServer::registerHandlers() {
         bool success = accountManager.registerUser(username, password, account_type);
 
         if (success) {
-            return "{\"status\":\"success\",\"message\":\"Registration successful\"}";
+            JsonWriter json;
+            json.beginObject().key("status").string("success").key("message").string("Registration successful").endObject();
+            return json.release();
         }
         else {
-            return "{\"status\":\"error\",\"message\":\"Username already exists\"}";
+            return errorResponse("Username already exists");
         }
     };
 
@@ -219,62 +262,65 @@ void HttpServer::registerHandlers() {
         bool success = accountManager.authenticateUser(username, password);
 
         if (success) {
-            return "{\"status\":\"success\",\"message\":\"Login successful\",\"username\":\"" + username + "\"}";
+            JsonWriter json;
+            json.beginObject()
+                .key("status").string("success")
+                .key("message").string("Login successful")
+                .key("username").string(username)
+                .endObject();
+            return json.release();
         }
         else {
-            return "{\"status\":\"error\",\"message\":\"Invalid username or password\"}";
+            return errorResponse("Invalid username or password");
         }
     };
 
     post_handlers["/api/deposit"] = [this](const std::map<std::string, std::string>& params) -> std::string {
         std::string username = params.at("username");
-        double amount = std::stod(params.at("amount"));
+        Money amount = parseAmount(params.at("amount"));
 
-        bool success = transactionManager.deposit(username, amount);
-        double new_balance = transactionManager.getBalance(username);
+        TransactionResult result = transactionManager.deposit(username, amount);
 
-        if (success) {
-            return "{\"status\":\"success\",\"message\":\"Deposit successful\",\"balance\":" + std::to_string(new_balance) + "}";
+        if (result.success) {
+            return balanceResponse("Deposit successful", result, "transaction_id", result.transactionId);
         }
         else {
-            return "{\"status\":\"error\",\"message\":\"Deposit failed\"}";
+            return errorResponse("Deposit failed");
         }
     };
 
     post_handlers["/api/withdraw"] = [this](const std::map<std::string, std::string>& params) -> std::string {
         std::string username = params.at("username");
-        double amount = std::stod(params.at("amount"));
+        Money amount = parseAmount(params.at("amount"));
 
-        bool success = transactionManager.withdraw(username, amount);
-        double new_balance = transactionManager.getBalance(username);
+        TransactionResult result = transactionManager.withdraw(username, amount);
 
-        if (success) {
-            return "{\"status\":\"success\",\"message\":\"Withdrawal successful\",\"balance\":" + std::to_string(new_balance) + "}";
+        if (result.success) {
+            return balanceResponse("Withdrawal successful", result, "transaction_id", result.transactionId);
         }
         else {
-            return "{\"status\":\"error\",\"message\":\"Withdrawal failed. Insufficient funds or invalid amount\"}";
+            return errorResponse("Withdrawal failed. Insufficient funds or invalid amount");
         }
     };
 
     post_handlers["/api/transfer"] = [this](const std::map<std::string, std::string>& params) -> std::string {
         std::string from_username = params.at("username");
         std::string to_username = params.at("to_username");
-        double amount = std::stod(params.at("amount"));
+        Money amount = parseAmount(params.at("amount"));
 
-        bool success = transactionManager.transfer(from_username, to_username, amount);
-        double new_balance = transactionManager.getBalance(from_username);
+        TransactionResult result = transactionManager.transfer(from_username, to_username, amount);
 
-        if (success) {
-            return "{\"status\":\"success\",\"message\":\"Transfer successful\",\"balance\":" + std::to_string(new_balance) + "}";
+        if (result.success) {
+            return balanceResponse("Transfer successful", result, "transaction_id", result.transactionId);
         }
         else {
-            return "{\"status\":\"error\",\"message\":\"Transfer failed. Check recipient username, amount, and your balance\"}";
+            return errorResponse("Transfer failed. Check recipient username, amount, and your balance");
         }
     };
 
     post_handlers["/api/create-deposit"] = [this](const std::map<std::string, std::string>& params) -> std::string {
         std::string username = params.at("username");
-        double amount = std::stod(params.at("amount"));
+        Money amount = parseAmount(params.at("amount"));
         int deposit_type = std::stoi(params.at("deposit_type"));
         int deposit_term = 0;
 
@@ -282,82 +328,97 @@ void HttpServer::registerHandlers() {
             deposit_term = std::stoi(params.at("deposit_term"));
         }
 
-        bool success = depositManager.createDeposit(username, amount, deposit_type, deposit_term);
-        double new_balance = transactionManager.getBalance(username);
+        TransactionResult result = depositManager.createDeposit(username, amount, deposit_type, deposit_term);
 
-        if (success) {
-            return "{\"status\":\"success\",\"message\":\"Deposit created successfully\",\"balance\":" + std::to_string(new_balance) + "}";
+        if (result.success) {
+            return balanceResponse("Deposit created successfully", result, "deposit_id", result.depositId);
         }
         else {
-            return "{\"status\":\"error\",\"message\":\"Failed to create deposit. Please check your balance and input.\"}";
+            return errorResponse("Failed to create deposit. Please check your balance and input.");
         }
     };
 
     post_handlers["/api/withdraw-deposit"] = [this](const std::map<std::string, std::string>& params) -> std::string {
         std::string username = params.at("username");
         std::string deposit_id = params.at("deposit_id");  // 使用字符串格式的ID
-        double amount = std::stod(params.at("amount"));
+        Money amount = parseAmount(params.at("amount"));
     
-        bool success = depositManager.withdrawDeposit(username, deposit_id, amount);
-        double new_balance = transactionManager.getBalance(username);
+        TransactionResult result = depositManager.withdrawDeposit(username, deposit_id, amount);
     
-        if (success) {
-            return "{\"status\":\"success\",\"message\":\"Withdrawal successful\",\"balance\":" + std::to_string(new_balance) + "}";
+        if (result.success) {
+            return balanceResponse("Withdrawal successful", result, nullptr, std::string());
         }
         else {
-            return "{\"status\":\"error\",\"message\":\"Withdrawal failed. Check if the deposit exists, the amount is valid, or if time deposit has matured.\"}";
+            return errorResponse("Withdrawal failed. Check if the deposit exists, the amount is valid, or if time deposit has matured.");
         }
     };
 
     // Register GET handlers
     get_handlers["/api/balance"] = [this](const std::map<std::string, std::string>& params) -> std::string {
         std::string username = params.at("username");
-        double balance = transactionManager.getBalance(username);
+        Money balance = transactionManager.getBalance(username);
 
         if (balance >= 0) {
-            return "{\"status\":\"success\",\"balance\":" + std::to_string(balance) + "}";
+            JsonWriter json;
+            json.beginObject().key("status").string("success").key("balance").money(balance).endObject();
+            return json.release();
         }
         else {
-            return "{\"status\":\"error\",\"message\":\"User not found\"}";
+            return errorResponse("User not found");
         }
     };
 
+    get_handlers["/api/stats"] = [this](const std::map<std::string, std::string>&) -> std::string {
+        AccountCache::Stats cache = accountManager.getCacheStats();
+        AccountManager::UsernameFilterStats filter = accountManager.getUsernameFilterStats();
+        uint64_t lookups = cache.hits + cache.misses;
+        double hit_rate = lookups > 0 ? static_cast<double>(cache.hits) / lookups : 0.0;
+
+        JsonWriter json(512);
+        json.beginObject()
+            .key("status").string("success")
+            .key("account_cache").beginObject()
+                .key("hits").unsignedInteger(cache.hits)
+                .key("misses").unsignedInteger(cache.misses)
+                .key("evictions").unsignedInteger(cache.evictions)
+                .key("invalidations").unsignedInteger(cache.invalidations)
+                .key("size").unsignedInteger(cache.size)
+                .key("capacity").unsignedInteger(cache.capacity)
+                .key("hit_rate").number(hit_rate)
+            .endObject()
+            .key("username_filter").beginObject()
+                .key("enabled").boolean(filter.enabled)
+                .key("rejects").unsignedInteger(filter.rejects)
+                .key("items").unsignedInteger(filter.items)
+                .key("capacity").unsignedInteger(filter.capacity)
+                .key("memory_bytes").unsignedInteger(filter.memoryBytes)
+            .endObject()
+            .endObject();
+        return json.release();
+    };
+
     get_handlers["/api/get-deposits"] = [this](const std::map<std::string, std::string>& params) -> std::string {
         std::string username = params.at("username");
         std::vector<Deposit> deposits = depositManager.getUserDeposits(username);
+        time_t current_time = time(nullptr);
     
-        std::string deposits_json = "[";
-        for (size_t i = 0; i < deposits.size(); i++) {
-            const auto& deposit = deposits[i];
-    
-            deposits_json += "{";
-            deposits_json += "\"id\":\"" + deposit.id + "\",";  // 使用字符串格式的ID
-            deposits_json += "\"amount\":" + std::to_string(deposit.amount) + ",";
-            deposits_json += "\"type\":" + std::to_string(deposit.type) + ",";
-    
-            if (deposit.type == TIME_DEPOSIT) {
-                deposits_json += "\"term\":" + std::to_string(deposit.term) + ",";
-            }
-    
-            deposits_json += "\"depositTime\":" + std::to_string(deposit.depositTime) + ",";
-            deposits_json += "\"currentTime\":" + std::to_string(time(nullptr)) + ",";
-            deposits_json += "\"isMatured\":" + std::string(deposit.isMatured ? "true" : "false");
-            deposits_json += "}";
-    
-            if (i < deposits.size() - 1) {
-                deposits_json += ",";
-            }
-        }
-        deposits_json += "]";
-    
-        return "{\"status\":\"success\",\"deposits\":" + deposits_json + "}";
+        // 按记录数预留，避免逐条追加时反复扩容
+        JsonWriter json(64 + deposits.size() * 128);
+        json.beginObject().key("status").string("success").key("deposits").beginArray();
+        for (const auto& deposit : deposits) {
+            json.beginObject();
+            writeDeposit(json, deposit, current_time);
+            json.key("isMatured").boolean(deposit.isMatured).endObject();
+        }
+        json.endArray().endObject();
+        return json.release();
     };
 
     get_handlers["/api/get-deposit-details"] = [this](const std::map<std::string, std::string>& params) -> std::string {
         try {
             // 检查必需参数是否存在
             if (params.find("username") == params.end() || params.find("deposit_id") == params.end()) {
-                return "{\"status\":\"error\",\"message\":\"Missing required parameters\"}";
+                return errorResponse("Missing required parameters");
             }
             
             std::string username = params.at("username");
@@ -370,48 +431,35 @@ void HttpServer::registerHandlers() {
             time_t current_time = time(nullptr);
     
             if (!deposit.id.empty()) {  // 检查ID是否为空
-                std::string deposit_json = "{";
-                deposit_json += "\"id\":\"" + deposit.id + "\",";  // 使用字符串格式的ID
-                deposit_json += "\"amount\":" + std::to_string(deposit.amount) + ",";
-                deposit_json += "\"type\":" + std::to_string(deposit.type) + ",";
-    
-                if (deposit.type == TIME_DEPOSIT) {
-                    deposit_json += "\"term\":" + std::to_string(deposit.term) + ",";
-                }
-    
-                deposit_json += "\"depositTime\":" + std::to_string(deposit.depositTime) + ",";
-                deposit_json += "\"currentTime\":" + std::to_string(current_time) + ",";
+                JsonWriter json(512);
+                json.beginObject().key("status").string("success").key("deposit").beginObject();
+                writeDeposit(json, deposit, current_time);
     
                 // 计算经过的时间
                 time_t elapsed_seconds = current_time - deposit.depositTime;
-                deposit_json += "\"elapsedSeconds\":" + std::to_string(elapsed_seconds) + ",";
+                json.key("elapsedSeconds").integer(elapsed_seconds);
     
                 // 检查定期存款是否到期
                 bool is_matured = false;
                 if (deposit.type == TIME_DEPOSIT) {
                     is_matured = elapsed_seconds >= deposit.term * 60;
                 }
-                deposit_json += "\"isMatured\":" + std::string(is_matured ? "true" : "false") + ",";
+                json.key("isMatured").boolean(is_matured);
     
                 // 计算不同时间点的利息
-                std::string interest_json = "[";
+                json.key("interestCalculations").beginArray();
     
                 if (deposit.type == DEMAND_DEPOSIT) {
                     // 活期存款: 30秒, 60秒, 90秒, 120秒
                     int time_points[] = { 30, 60, 90, 120 };
     
                     for (size_t i = 0; i < 4; i++) {
-                        double interest = depositManager.calculateInterest(deposit, time_points[i]);
-    
-                        interest_json += "{";
-                        interest_json += "\"time\":" + std::to_string(time_points[i]) + ",";
-                        interest_json += "\"interest\":" + std::to_string(interest) + ",";
-                        interest_json += "\"total\":" + std::to_string(deposit.amount + interest);
-                        interest_json += "}";
-    
-                        if (i < 3) {
-                            interest_json += ",";
-                        }
+                        Money interest = depositManager.calculateInterest(deposit, time_points[i]);
+                        json.beginObject()
+                            .key("time").integer(time_points[i])
+                            .key("interest").money(interest)
+                            .key("total").money(deposit.amount + interest)
+                            .endObject();
                     }
                 }
                 else if (deposit.type == TIME_DEPOSIT) {
@@ -419,85 +467,85 @@ void HttpServer::registerHandlers() {
                     int time_points[] = { 3, 6, 9, 12 };
     
                     for (size_t i = 0; i < 4; i++) {
-                        double interest = depositManager.calculateInterest(deposit, time_points[i] * 60);
-    
-                        interest_json += "{";
-                        interest_json += "\"time\":" + std::to_string(time_points[i]) + ",";
-                        interest_json += "\"interest\":" + std::to_string(interest) + ",";
-                        interest_json += "\"total\":" + std::to_string(deposit.amount + interest);
-                        interest_json += "}";
-    
-                        if (i < 3) {
-                            interest_json += ",";
-                        }
+                        Money interest = depositManager.calculateInterest(deposit, time_points[i] * 60);
+                        json.beginObject()
+                            .key("time").integer(time_points[i])
+                            .key("interest").money(interest)
+                            .key("total").money(deposit.amount + interest)
+                            .endObject();
                     }
                 }
     
-                interest_json += "]";
-                deposit_json += "\"interestCalculations\":" + interest_json;
-                deposit_json += "}";
-    
-                std::string response = "{\"status\":\"success\",\"deposit\":" + deposit_json + "}";
+                json.endArray().endObject().endObject();
                 std::cout << "API响应: 成功返回存款详情, id=" << deposit.id << std::endl;
-                return response;
+                return json.release();
             }
             else {
                 std::cout << "API错误: 未找到存款, username=" << username << ", deposit_id=" << deposit_id << std::endl;
-                return "{\"status\":\"error\",\"message\":\"Deposit not found\"}";
+                return errorResponse("Deposit not found");
             }
         }
         catch (const std::exception& e) {
             std::cerr << "API异常: " << e.what() << std::endl;
-            return "{\"status\":\"error\",\"message\":\"Server error: " + std::string(e.what()) + "\"}";
+            return errorResponse(std::string("Server error: ") + e.what());
         }
         catch (...) {
             std::cerr << "API异常: 未知错误" << std::endl;
-            return "{\"status\":\"error\",\"message\":\"Unknown server error\"}";
+            return errorResponse("Unknown server error");
         }
     };
 
     get_handlers["/api/transaction-history"] = [this](const std::map<std::string, std::string>& params) -> std::string {
         try {
             std::string username = params.at("username");
-            std::vector<TransactionRecord> transactions = transactionManager.getTransactionHistory(username);
-            
-            std::string transactions_json = "[";
-            for (size_t i = 0; i < transactions.size(); i++) {
-                const auto& tx = transactions[i];
-                
-                transactions_json += "{";
-                transactions_json += "\"id\":\"" + tx.id + "\",";
-                transactions_json += "\"type\":" + std::to_string(tx.type) + ",";
-                transactions_json += "\"amount\":" + std::to_string(tx.amount) + ",";
-                transactions_json += "\"balance_after\":" + std::to_string(tx.balance_after) + ",";
-                
-                // 对交易对方进行特殊处理，避免JSON语法错误
-                if (!tx.counterparty.empty()) {
-                    transactions_json += "\"counterparty\":\"" + tx.counterparty + "\",";
-                } else {
-                    transactions_json += "\"counterparty\":\"\",";
-                }
-                
-                // 对描述进行特殊处理，避免JSON语法错误
-                if (!tx.description.empty()) {
-                    transactions_json += "\"description\":\"" + tx.description + "\",";
-                } else {
-                    transactions_json += "\"description\":\"\",";
-                }
-                
-                transactions_json += "\"timestamp\":" + std::to_string(tx.timestamp);
-                transactions_json += "}";
-                
-                if (i < transactions.size() - 1) {
-                    transactions_json += ",";
+
+            // 分页参数：limit（默认50，最多1000）和上一页返回的cursor，新记录在前
+            size_t limit = TransactionManager::DEFAULT_HISTORY_PAGE;
+            auto limitParam = params.find("limit");
+            if (limitParam != params.end()) {
+                char* end = nullptr;
+                unsigned long value = std::strtoul(limitParam->second.c_str(), &end, 10);
+                if (limitParam->second.empty() || *end != '\0' || value == 0 ||
+                    value > TransactionManager::MAX_HISTORY_PAGE) {
+                    return errorResponse("Invalid limit");
                 }
+                limit = value;
             }
-            transactions_json += "]";
+            auto cursorParam = params.find("cursor");
+            std::string cursor = cursorParam == params.end() ? std::string() : cursorParam->second;
+
+            TransactionPage page;
+            if (!transactionManager.getTransactionPage(username, limit, cursor, page)) {
+                return errorResponse("Invalid cursor");
+            }
+            const std::vector<TransactionRecord>& transactions = page.transactions;
             
-            return "{\"status\":\"success\",\"transactions\":" + transactions_json + "}";
+            // 交易对方和描述来自用户输入，由写入器转义
+            JsonWriter json(128 + transactions.size() * 160);
+            json.beginObject().key("status").string("success").key("transactions").beginArray();
+            for (const auto& tx : transactions) {
+                json.beginObject()
+                    .key("id").string(tx.id)
+                    .key("type").integer(tx.type)
+                    .key("amount").money(tx.amount)
+                    .key("balance_after").money(tx.balance_after)
+                    .key("counterparty").string(tx.counterparty)
+                    .key("description").string(tx.description)
+                    .key("timestamp").integer(tx.timestamp)
+                    .endObject();
+            }
+            json.endArray();
+            if (page.nextCursor.empty()) {
+                json.key("next_cursor").null();
+            }
+            else {
+                json.key("next_cursor").string(page.nextCursor);
+            }
+            json.key("total").unsignedInteger(page.total).endObject();
+            return json.release();
         }
         catch (const std::exception& e) {
-            return "{\"status\":\"error\",\"message\":\"" + std::string(e.what()) + "\"}";
+            return errorResponse(e.what());
         }
     };
 }
\ No newline at end of file
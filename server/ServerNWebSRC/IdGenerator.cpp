@@ -0,0 +1,47 @@
+// IdGenerator.cpp - Implementation of the Snowflake-style ID generator
+#include "IdGenerator.h"
+#include <chrono>
+
+const unsigned IdGenerator::NODE_BITS;
+const unsigned IdGenerator::SEQUENCE_BITS;
+const unsigned IdGenerator::MAX_NODE_ID;
+const uint64_t IdGenerator::EPOCH_MS;
+
+IdGenerator::IdGenerator(unsigned nodeId)
+    : nodeId(nodeId & MAX_NODE_ID), last(0) {
+}
+
+uint64_t IdGenerator::currentMillis() {
+    uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return now > EPOCH_MS ? now - EPOCH_MS : 0;
+}
+
+uint64_t IdGenerator::next() {
+    uint64_t candidate = currentMillis() << SEQUENCE_BITS;
+    uint64_t previous = last.load(std::memory_order_relaxed);
+    uint64_t value;
+    do {
+        // 同一毫秒内递增序列号；序列号用尽或时钟回拨时沿用上一个值加一，保证单调
+        value = candidate > previous ? candidate : previous + 1;
+    } while (!last.compare_exchange_weak(previous, value, std::memory_order_relaxed));
+
+    uint64_t timestamp = value >> SEQUENCE_BITS;
+    uint64_t sequence = value & ((1ULL << SEQUENCE_BITS) - 1);
+    return (timestamp << (NODE_BITS + SEQUENCE_BITS)) |
+           (static_cast<uint64_t>(nodeId) << SEQUENCE_BITS) | sequence;
+}
+
+std::string IdGenerator::nextString(const char* prefix) {
+    static const char HEX[] = "0123456789ABCDEF";
+    uint64_t id = next();
+
+    std::string result(prefix);
+    size_t prefixLength = result.size();
+    result.resize(prefixLength + 16);
+    for (size_t i = 16; i > 0; i--) {
+        result[prefixLength + i - 1] = HEX[id & 0xF];
+        id >>= 4;
+    }
+    return result;
+}
@@ -0,0 +1,240 @@
+// JsonWriter.cpp - Implementation of the append-only JSON builder
+#include "JsonWriter.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// 需要转义的字节：'"'、'\\'和0x00-0x1F
+inline bool needsEscape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+// 从pos起第一个需要转义的字节的位置，没有则返回len
+size_t findEscape(const char* data, size_t pos, size_t len) {
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i controlMax = _mm_set1_epi8(0x1F);
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        // 无符号比较 c <= 0x1F 等价于 max(c, 0x1F) == 0x1F（不误判UTF-8的高位字节）
+        __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(block, controlMax), controlMax);
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(control, special)));
+        if (mask != 0) {
+            return pos + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; pos < len; pos++) {
+        if (needsEscape(static_cast<unsigned char>(data[pos]))) {
+            return pos;
+        }
+    }
+    return len;
+}
+
+const char DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+} // namespace
+
+JsonWriter::JsonWriter(size_t reserve) : needComma(false) {
+    out.reserve(reserve);
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separator();
+    out += '{';
+    needComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    out += '}';
+    needComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separator();
+    out += '[';
+    needComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    out += ']';
+    needComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* name) {
+    separator();
+    out += '"';
+    appendEscaped(out, name, std::strlen(name));
+    out += "\":";
+    needComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const std::string& name) {
+    separator();
+    out += '"';
+    appendEscaped(out, name.data(), name.size());
+    out += "\":";
+    needComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::string(const char* value) {
+    separator();
+    out += '"';
+    appendEscaped(out, value, std::strlen(value));
+    out += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::string(const std::string& value) {
+    separator();
+    out += '"';
+    appendEscaped(out, value.data(), value.size());
+    out += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::integer(long long value) {
+    separator();
+    appendInteger(out, value);
+    return *this;
+}
+
+JsonWriter& JsonWriter::unsignedInteger(unsigned long long value) {
+    separator();
+    appendUnsigned(out, value);
+    return *this;
+}
+
+JsonWriter& JsonWriter::number(double value) {
+    separator();
+    appendNumber(out, value);
+    return *this;
+}
+
+JsonWriter& JsonWriter::money(Money amount) {
+    separator();
+    MoneyUtil::append(out, amount);
+    return *this;
+}
+
+JsonWriter& JsonWriter::boolean(bool value) {
+    separator();
+    out += value ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separator();
+    out += "null";
+    return *this;
+}
+
+std::string JsonWriter::release() {
+    std::string result;
+    result.swap(out);
+    needComma = false;
+    return result;
+}
+
+void JsonWriter::appendEscaped(std::string& out, const char* data, size_t len) {
+    static const char HEX[] = "0123456789abcdef";
+    size_t pos = 0;
+    while (pos < len) {
+        // 整段追加无需转义的内容
+        size_t next = findEscape(data, pos, len);
+        out.append(data + pos, next - pos);
+        if (next == len) {
+            break;
+        }
+
+        unsigned char c = static_cast<unsigned char>(data[next]);
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        default: {
+            char escaped[6] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF] };
+            out.append(escaped, sizeof(escaped));
+            break;
+        }
+        }
+        pos = next + 1;
+    }
+}
+
+void JsonWriter::appendUnsigned(std::string& out, unsigned long long value) {
+    // 每次输出两位
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* p = end;
+    while (value >= 100) {
+        unsigned pair = static_cast<unsigned>(value % 100) * 2;
+        value /= 100;
+        *--p = DIGIT_PAIRS[pair + 1];
+        *--p = DIGIT_PAIRS[pair];
+    }
+    if (value >= 10) {
+        unsigned pair = static_cast<unsigned>(value) * 2;
+        *--p = DIGIT_PAIRS[pair + 1];
+        *--p = DIGIT_PAIRS[pair];
+    }
+    else {
+        *--p = static_cast<char>('0' + value);
+    }
+    out.append(p, end - p);
+}
+
+void JsonWriter::appendInteger(std::string& out, long long value) {
+    if (value < 0) {
+        out += '-';
+        appendUnsigned(out, 0 - static_cast<unsigned long long>(value));
+        return;
+    }
+    appendUnsigned(out, static_cast<unsigned long long>(value));
+}
+
+void JsonWriter::appendNumber(std::string& out, double value) {
+    if (!std::isfinite(value)) {
+        out += "null";
+        return;
+    }
+    // 整数值直接输出
+    if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+        appendInteger(out, static_cast<long long>(value));
+        return;
+    }
+
+    // 依次尝试更多有效数字，取第一个能精确还原的（最多17位）
+    char buffer[32];
+    int len = 0;
+    for (int precision = 15; precision <= 17; precision++) {
+        len = std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+        if (precision == 17 || std::strtod(buffer, nullptr) == value) {
+            break;
+        }
+    }
+    out.append(buffer, static_cast<size_t>(len));
+}
@@ -0,0 +1,49 @@
+// LockStripes.cpp - Implementation of striped account locks
+#include "LockStripes.h"
+#include <cstdint>
+
+const size_t LockStripes::STRIPE_COUNT;
+
+size_t LockStripes::stripeIndex(const std::string& key) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(hash & (STRIPE_COUNT - 1));
+}
+
+LockStripes::Guard::Guard(LockStripes& stripes, const std::string& key) : count(1) {
+    locks[0] = &stripes.stripe(stripeIndex(key));
+    locks[1] = nullptr;
+    locks[0]->lock();
+}
+
+LockStripes::Guard::Guard(LockStripes& stripes, const std::string& first, const std::string& second) : count(2) {
+    size_t a = stripeIndex(first);
+    size_t b = stripeIndex(second);
+    if (a > b) {
+        size_t tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    locks[0] = &stripes.stripe(a);
+    locks[1] = &stripes.stripe(b);
+    // 同一条带只锁一次
+    if (a == b) {
+        count = 1;
+        locks[1] = nullptr;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        locks[i]->lock();
+    }
+}
+
+LockStripes::Guard::~Guard() {
+    for (size_t i = count; i > 0; i--) {
+        locks[i - 1]->unlock();
+    }
+}
@@ -0,0 +1,190 @@
+// LogFormat.cpp - Encoding/decoding of segment log records
+#include "LogFormat.h"
+#include <cstring>
+#include <cstdlib>
+
+namespace {
+
+const char SEGMENT_MAGIC[4] = { 'B', 'K', 'S', 'G' };
+
+// 记录负载的上限，防止损坏的长度字段导致超大分配
+const uint32_t MAX_PAYLOAD_SIZE = 64 * 1024 * 1024;
+
+void putU32(std::string& out, uint32_t v) {
+    char buf[4];
+    buf[0] = static_cast<char>(v & 0xff);
+    buf[1] = static_cast<char>((v >> 8) & 0xff);
+    buf[2] = static_cast<char>((v >> 16) & 0xff);
+    buf[3] = static_cast<char>((v >> 24) & 0xff);
+    out.append(buf, 4);
+}
+
+void putU64(std::string& out, uint64_t v) {
+    putU32(out, static_cast<uint32_t>(v & 0xffffffffu));
+    putU32(out, static_cast<uint32_t>(v >> 32));
+}
+
+uint32_t getU32(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint32_t>(u[0]) | (static_cast<uint32_t>(u[1]) << 8) |
+        (static_cast<uint32_t>(u[2]) << 16) | (static_cast<uint32_t>(u[3]) << 24);
+}
+
+uint64_t getU64(const char* p) {
+    return static_cast<uint64_t>(getU32(p)) | (static_cast<uint64_t>(getU32(p + 4)) << 32);
+}
+
+void putString(std::string& out, const std::string& s) {
+    putU32(out, static_cast<uint32_t>(s.size()));
+    out.append(s);
+}
+
+bool getString(const char* data, size_t len, size_t& pos, std::string& s) {
+    if (len - pos < 4) {
+        return false;
+    }
+    uint32_t n = getU32(data + pos);
+    pos += 4;
+    if (len - pos < n) {
+        return false;
+    }
+    s.assign(data + pos, n);
+    pos += n;
+    return true;
+}
+
+bool hasField(LogOp op) {
+    return op == LOG_HSET || op == LOG_HDEL || op == LOG_LSET;
+}
+
+bool hasValue(LogOp op) {
+    return op == LOG_SET || op == LOG_HSET || op == LOG_LPUSH || op == LOG_RPUSH || op == LOG_LSET;
+}
+
+struct Crc32Table {
+    uint32_t entries[256];
+
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            entries[i] = c;
+        }
+    }
+};
+
+} // namespace
+
+uint32_t LogFormat::crc32(const char* data, size_t len) {
+    static const Crc32Table table;
+    uint32_t c = 0xFFFFFFFFu;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < len; i++) {
+        c = table.entries[(c ^ p[i]) & 0xff] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+void LogFormat::encode(const LogRecord& record, std::string& out) {
+    std::string payload;
+    payload.reserve(16 + record.key.size() + record.field.size() + record.value.size());
+    payload.push_back(static_cast<char>(record.op));
+    putU64(payload, record.lsn);
+    putString(payload, record.key);
+    if (hasField(record.op)) {
+        putString(payload, record.field);
+    }
+    if (hasValue(record.op)) {
+        putString(payload, record.value);
+    }
+
+    putU32(out, static_cast<uint32_t>(payload.size()));
+    putU32(out, crc32(payload.data(), payload.size()));
+    out.append(payload);
+}
+
+bool LogFormat::decode(const char* data, size_t len, size_t& pos, LogRecord& record, uint8_t version) {
+    if (pos > len || len - pos < FRAME_HEADER_SIZE) {
+        return false;
+    }
+    uint32_t payloadSize = getU32(data + pos);
+    uint32_t checksum = getU32(data + pos + 4);
+    if (payloadSize == 0 || payloadSize > MAX_PAYLOAD_SIZE || len - pos - FRAME_HEADER_SIZE < payloadSize) {
+        return false;
+    }
+
+    const char* payload = data + pos + FRAME_HEADER_SIZE;
+    if (crc32(payload, payloadSize) != checksum) {
+        return false;
+    }
+
+    size_t p = 0;
+    record.op = static_cast<LogOp>(static_cast<unsigned char>(payload[p++]));
+    if (record.op < LOG_SET || record.op > LOG_LSET) {
+        return false;
+    }
+    record.lsn = 0;
+    if (version >= 2) {
+        if (payloadSize - p < 8) {
+            return false;
+        }
+        record.lsn = getU64(payload + p);
+        p += 8;
+    }
+    if (!getString(payload, payloadSize, p, record.key)) {
+        return false;
+    }
+    record.field.clear();
+    record.value.clear();
+    if (hasField(record.op) && !getString(payload, payloadSize, p, record.field)) {
+        return false;
+    }
+    if (hasValue(record.op) && !getString(payload, payloadSize, p, record.value)) {
+        return false;
+    }
+
+    pos += FRAME_HEADER_SIZE + payloadSize;
+    return true;
+}
+
+bool LogFormat::apply(const LogRecord& record, StorageBackend& target) {
+    switch (record.op) {
+    case LOG_SET:
+        return target.set(record.key, record.value);
+    case LOG_DEL:
+        return target.del(record.key);
+    case LOG_HSET:
+        return target.hset(record.key, record.field, record.value);
+    case LOG_HDEL:
+        return target.hdel(record.key, record.field);
+    case LOG_LPUSH:
+        return target.lpush(record.key, record.value);
+    case LOG_RPUSH:
+        return target.rpush(record.key, record.value);
+    case LOG_LSET:
+        return target.lset(record.key, std::atoi(record.field.c_str()), record.value);
+    }
+    return false;
+}
+
+std::string LogFormat::segmentHeader(uint8_t flags) {
+    std::string header(SEGMENT_MAGIC, 4);
+    header.push_back(static_cast<char>(SEGMENT_VERSION));
+    header.push_back(static_cast<char>(flags));
+    header.append(2, '\0');
+    return header;
+}
+
+bool LogFormat::parseSegmentHeader(const char* data, size_t len, uint8_t& flags, uint8_t& version) {
+    if (len < SEGMENT_HEADER_SIZE || std::memcmp(data, SEGMENT_MAGIC, 4) != 0) {
+        return false;
+    }
+    version = static_cast<uint8_t>(data[4]);
+    if (version < 1 || version > SEGMENT_VERSION) {
+        return false;
+    }
+    flags = static_cast<uint8_t>(data[5]);
+    return true;
+}
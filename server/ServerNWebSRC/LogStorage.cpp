@@ -0,0 +1,712 @@
+// LogStorage.cpp - Implementation of the embedded log-structured storage engine
+#include "LogStorage.h"
+#include "Snapshot.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+
+const char SEGMENT_PREFIX[] = "segment-";
+const char SEGMENT_SUFFIX[] = ".log";
+const char SNAPSHOT_PREFIX[] = "snapshot-";
+const char SNAPSHOT_SUFFIX[] = ".snap";
+
+bool writeAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool readFile(const std::string& path, std::string& out) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    out.clear();
+    char buf[64 * 1024];
+    while (true) {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ::close(fd);
+            return false;
+        }
+        if (n == 0) {
+            break;
+        }
+        out.append(buf, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return true;
+}
+
+bool readSegmentFlags(const std::string& path, uint8_t& flags) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    char header[LogFormat::SEGMENT_HEADER_SIZE];
+    ssize_t n = ::read(fd, header, sizeof(header));
+    ::close(fd);
+    uint8_t version = 0;
+    return n == static_cast<ssize_t>(sizeof(header)) &&
+        LogFormat::parseSegmentHeader(header, sizeof(header), flags, version);
+}
+
+void syncDirectory(const std::string& dir) {
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+// 列出目录中 prefix<数字>suffix 形式的文件编号（升序）；removeOthers时删除同前缀的临时文件
+std::vector<uint64_t> listNumbered(const std::string& dir, const char* prefix, const char* suffix, bool removeOthers) {
+    std::vector<uint64_t> ids;
+    DIR* d = ::opendir(dir.c_str());
+    if (d == nullptr) {
+        return ids;
+    }
+    size_t prefixLen = strlen(prefix);
+    while (struct dirent* entry = ::readdir(d)) {
+        std::string name = entry->d_name;
+        if (name.compare(0, prefixLen, prefix) != 0) {
+            continue;
+        }
+        unsigned long long id = 0;
+        char rest[16] = { 0 };
+        if (sscanf(name.c_str() + prefixLen, "%llu%15s", &id, rest) == 2 && strcmp(rest, suffix) == 0) {
+            ids.push_back(id);
+        }
+        else if (removeOthers) {
+            // 写到一半的临时文件（压缩/快照中途崩溃）
+            ::unlink((dir + "/" + name).c_str());
+        }
+    }
+    ::closedir(d);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+} // namespace
+
+LogStorage::LogStorage(const std::string& dataDir, uint64_t segmentSize, unsigned commitIntervalUs,
+                       unsigned snapshotInterval, size_t snapshotSegments)
+    : dataDir(dataDir), segmentSize(segmentSize), snapshotInterval(snapshotInterval),
+      snapshotSegments(snapshotSegments), wal(commitIntervalUs), activeId(0), activeSize(0), lastLsn(0),
+      stopping(false), connected(false) {
+    if (this->snapshotInterval < 1) {
+        this->snapshotInterval = 1;
+    }
+    if (this->snapshotSegments < 1) {
+        this->snapshotSegments = 1;
+    }
+    for (size_t i = 0; i < MemoryStorage::SHARD_COUNT; i++) {
+        shardLsn[i] = 0;
+    }
+}
+
+LogStorage::~LogStorage() {
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        stopping = true;
+    }
+    snapshotCv.notify_all();
+    if (snapshotter.joinable()) {
+        snapshotter.join();
+    }
+
+    // 刷盘并关闭活动段
+    wal.stop();
+}
+
+std::string LogStorage::segmentPath(uint64_t id) const {
+    char name[64];
+    snprintf(name, sizeof(name), "%s%010llu%s", SEGMENT_PREFIX, static_cast<unsigned long long>(id), SEGMENT_SUFFIX);
+    return dataDir + "/" + name;
+}
+
+std::string LogStorage::snapshotPath(uint64_t baseSegment) const {
+    char name[64];
+    snprintf(name, sizeof(name), "%s%010llu%s", SNAPSHOT_PREFIX, static_cast<unsigned long long>(baseSegment),
+             SNAPSHOT_SUFFIX);
+    return dataDir + "/" + name;
+}
+
+bool LogStorage::connect() {
+    if (connected) {
+        return true;
+    }
+
+    if (::mkdir(dataDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "无法创建数据目录 " << dataDir << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (!recover()) {
+        return false;
+    }
+
+    wal.start();
+    snapshotter = std::thread(&LogStorage::snapshotLoop, this);
+    connected = true;
+    return true;
+}
+
+bool LogStorage::isConnected() const {
+    return connected;
+}
+
+bool LogStorage::recover() {
+    DIR* dir = ::opendir(dataDir.c_str());
+    if (dir == nullptr) {
+        std::cerr << "无法打开数据目录 " << dataDir << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    ::closedir(dir);
+
+    std::vector<uint64_t> ids = listNumbered(dataDir, SEGMENT_PREFIX, SEGMENT_SUFFIX, true);
+    std::vector<uint64_t> snapshots = listNumbered(dataDir, SNAPSHOT_PREFIX, SNAPSHOT_SUFFIX, true);
+
+    // 加载最新的快照。快照写完后才改名生效，且生效后它覆盖的段已被删除，
+    // 所以最新快照无法读取时不能退回更早的快照或空状态，保留全部文件并拒绝启动
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint64_t> cutLsns(MemoryStorage::SHARD_COUNT, 0);
+    uint64_t base = 0;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    if (!snapshots.empty()) {
+        std::string path = snapshotPath(snapshots.back());
+        std::vector<uint64_t> cuts;
+        if (!SnapshotReader::load(path, index, cuts, base, threads) ||
+            cuts.size() != MemoryStorage::SHARD_COUNT) {
+            std::cerr << "快照无效，无法恢复（未删除任何文件）: " << path << std::endl;
+            index.clear();
+            return false;
+        }
+        cutLsns = cuts;
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        std::cout << "Loaded snapshot " << path << " in " << elapsed.count() << " ms" << std::endl;
+    }
+    for (size_t i = 0; i < MemoryStorage::SHARD_COUNT; i++) {
+        shardLsn[i] = cutLsns[i];
+        lastLsn = std::max(lastLsn, cutLsns[i]);
+    }
+
+    // 快照已包含基准段及之前的所有段
+    size_t covered = 0;
+    while (covered < ids.size() && ids[covered] <= base) {
+        ::unlink(segmentPath(ids[covered]).c_str());
+        covered++;
+    }
+    ids.erase(ids.begin(), ids.begin() + covered);
+
+    // 旧版本的压缩段包含完整状态，更早的段可以丢弃
+    size_t compacted = 0;
+    for (size_t i = ids.size(); i-- > 0;) {
+        uint8_t flags = 0;
+        if (readSegmentFlags(segmentPath(ids[i]), flags) && (flags & SEGMENT_COMPACTED)) {
+            compacted = i;
+            break;
+        }
+    }
+    for (size_t i = 0; i < compacted; i++) {
+        ::unlink(segmentPath(ids[i]).c_str());
+    }
+    ids.erase(ids.begin(), ids.begin() + compacted);
+
+    // 只重放快照之后的日志尾部
+    auto replayStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (!replaySegment(ids[i], i + 1 == ids.size(), cutLsns)) {
+            return false;
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - replayStart);
+    std::cout << "Replayed " << ids.size() << " log segment(s) from " << dataDir
+              << " in " << elapsed.count() << " ms" << std::endl;
+
+    // 只保留已加载的快照（更早的快照已被它取代）
+    for (uint64_t snapshot : snapshots) {
+        if (snapshot != base) {
+            ::unlink(snapshotPath(snapshot).c_str());
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(logMutex);
+    sealedSegments = ids;
+    uint64_t nextId = std::max(base, ids.empty() ? 0 : ids.back()) + 1;
+    return openSegment(nextId);
+}
+
+bool LogStorage::replaySegment(uint64_t id, bool truncateTail, const std::vector<uint64_t>& cutLsns) {
+    std::string path = segmentPath(id);
+    std::string data;
+    if (!readFile(path, data)) {
+        std::cerr << "无法读取段文件 " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    uint8_t flags = 0;
+    uint8_t version = 0;
+    if (!LogFormat::parseSegmentHeader(data.data(), data.size(), flags, version)) {
+        std::cerr << "段文件头无效: " << path << std::endl;
+        return false;
+    }
+
+    size_t pos = LogFormat::SEGMENT_HEADER_SIZE;
+    LogRecord record;
+    while (pos < data.size() && LogFormat::decode(data.data(), data.size(), pos, record, version)) {
+        // 已包含在快照中的记录跳过（旧版本记录没有LSN，总是应用）
+        size_t shard = MemoryStorage::shardIndex(record.key);
+        if (record.lsn != 0 && record.lsn <= cutLsns[shard]) {
+            continue;
+        }
+        LogFormat::apply(record, index);
+        if (record.lsn > shardLsn[shard]) {
+            shardLsn[shard] = record.lsn;
+        }
+        lastLsn = std::max(lastLsn, record.lsn);
+    }
+
+    if (pos < data.size()) {
+        if (!truncateTail) {
+            std::cerr << "段文件损坏: " << path << " (offset " << pos << ")" << std::endl;
+            return false;
+        }
+        // 最后一个段的尾部可能是写到一半的记录，截断即可
+        std::cerr << "截断段文件尾部不完整的记录: " << path << " (offset " << pos << ")" << std::endl;
+        if (::truncate(path.c_str(), static_cast<off_t>(pos)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 调用时持有logMutex
+bool LogStorage::openSegment(uint64_t id) {
+    std::string path = segmentPath(id);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd < 0) {
+        std::cerr << "无法创建段文件 " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    std::string header = LogFormat::segmentHeader(0);
+    if (!writeAll(fd, header.data(), header.size())) {
+        ::close(fd);
+        return false;
+    }
+
+    // 旧段在切换时刷盘并关闭
+    wal.switchFile(fd);
+    activeId = id;
+    activeSize = header.size();
+    return true;
+}
+
+uint64_t LogStorage::append(LogRecord& record) {
+    bool full = false;
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        record.lsn = lastLsn + 1;
+
+        std::string frame;
+        LogFormat::encode(record, frame);
+        if (wal.append(frame) == 0) {
+            return 0;
+        }
+        lastLsn = record.lsn;
+        activeSize += frame.size();
+
+        // 段写满后封存并切换到新段。记录已在当前段中，切换失败不影响本次写入：
+        // 继续写当前段，下次追加时重试
+        if (activeSize >= segmentSize) {
+            uint64_t sealedId = activeId;
+            if (openSegment(activeId + 1)) {
+                sealedSegments.push_back(sealedId);
+                full = sealedSegments.size() >= snapshotSegments;
+            }
+            else {
+                std::cerr << "段切换失败，继续写入段 " << sealedId << std::endl;
+            }
+        }
+    }
+
+    if (full) {
+        snapshotCv.notify_one();
+    }
+    return record.lsn;
+}
+
+bool LogStorage::canApply(const LogRecord& record) {
+    std::string keyType = index.type(record.key);
+    switch (record.op) {
+    case LOG_SET:
+        return true;
+    case LOG_DEL:
+        return keyType != "none";
+    case LOG_HSET:
+        return keyType == "none" || keyType == "hash";
+    case LOG_HDEL:
+        return index.hexists(record.key, record.field);
+    case LOG_LPUSH:
+    case LOG_RPUSH:
+        return keyType == "none" || keyType == "list";
+    case LOG_LSET: {
+        if (keyType != "list") {
+            return false;
+        }
+        long size = static_cast<long>(index.llen(record.key));
+        long position = std::atoi(record.field.c_str());
+        if (position < 0) {
+            position += size;
+        }
+        return position >= 0 && position < size;
+    }
+    }
+    return false;
+}
+
+bool LogStorage::mutate(LogRecord& record) {
+    size_t shard = MemoryStorage::shardIndex(record.key);
+    std::lock_guard<std::mutex> lock(stripes[shard]);
+
+    // 未改变状态的操作（如删除不存在的键）不写日志。
+    // 条带锁内索引中该键不会被其他写入修改，检查结果与随后的应用一致
+    if (!canApply(record)) {
+        return false;
+    }
+
+    // 日志写入成功后才修改索引，写入失败时读者看不到这次修改，重启后也不会出现
+    uint64_t lsn = append(record);
+    if (lsn == 0) {
+        return false;
+    }
+    LogFormat::apply(record, index);
+    shardLsn[shard] = lsn;
+    return true;
+}
+
+void LogStorage::restoreString(const std::string& key, const std::string& previous) {
+    if (previous.empty()) {
+        index.del(key);
+    }
+    else {
+        index.set(key, previous);
+    }
+}
+
+void LogStorage::restoreField(const std::string& key, const std::string& field, const std::string& previous) {
+    if (previous.empty()) {
+        index.hdel(key, field);
+    }
+    else {
+        index.hset(key, field, previous);
+    }
+}
+
+void LogStorage::snapshotLoop() {
+    uint64_t snapshotLsn = 0;
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        snapshotLsn = lastLsn;
+    }
+
+    std::unique_lock<std::mutex> lock(snapshotMutex);
+    while (!stopping) {
+        snapshotCv.wait_for(lock, std::chrono::seconds(snapshotInterval));
+        if (stopping) {
+            break;
+        }
+
+        // 自上次快照以来没有写入则跳过
+        uint64_t current = 0;
+        {
+            std::lock_guard<std::mutex> logLock(logMutex);
+            current = lastLsn;
+        }
+        if (current == snapshotLsn) {
+            continue;
+        }
+
+        lock.unlock();
+        if (takeSnapshot()) {
+            snapshotLsn = current;
+        }
+        lock.lock();
+    }
+}
+
+bool LogStorage::takeSnapshot() {
+    auto start = std::chrono::steady_clock::now();
+
+    // 封存当前段：此前写入的记录都会包含在快照中
+    uint64_t base = 0;
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        base = activeId;
+        sealedSegments.push_back(activeId);
+        if (!openSegment(activeId + 1)) {
+            return false;
+        }
+    }
+
+    SnapshotWriter writer(snapshotPath(base));
+    if (!writer.open()) {
+        return false;
+    }
+
+    // 逐个分片复制：写入者只在所属分片被编码的瞬间等待，文件写入在锁外进行
+    for (size_t i = 0; i < MemoryStorage::SHARD_COUNT; i++) {
+        uint64_t cut = 0;
+        {
+            std::lock_guard<std::mutex> lock(stripes[i]);
+            index.visitShard(i, writer);
+            cut = shardLsn[i];
+        }
+        if (!writer.writeShard(cut)) {
+            return false;
+        }
+    }
+    if (!writer.commit(base)) {
+        return false;
+    }
+    syncDirectory(dataDir);
+
+    // 删除快照已覆盖的段和旧快照
+    std::vector<uint64_t> covered;
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        auto it = sealedSegments.begin();
+        while (it != sealedSegments.end() && *it <= base) {
+            covered.push_back(*it);
+            ++it;
+        }
+        sealedSegments.erase(sealedSegments.begin(), it);
+    }
+    for (uint64_t id : covered) {
+        ::unlink(segmentPath(id).c_str());
+    }
+    for (uint64_t snapshot : listNumbered(dataDir, SNAPSHOT_PREFIX, SNAPSHOT_SUFFIX, false)) {
+        if (snapshot < base) {
+            ::unlink(snapshotPath(snapshot).c_str());
+        }
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "Snapshot " << base << " written (" << writer.bytesWritten() << " bytes, "
+              << covered.size() << " segment(s) released) in " << elapsed.count() << " ms" << std::endl;
+    return true;
+}
+
+bool LogStorage::set(const std::string& key, const std::string& value) {
+    LogRecord record;
+    record.op = LOG_SET;
+    record.key = key;
+    record.value = value;
+    return mutate(record);
+}
+
+std::string LogStorage::get(const std::string& key) {
+    return index.get(key);
+}
+
+bool LogStorage::exists(const std::string& key) {
+    return index.exists(key);
+}
+
+bool LogStorage::del(const std::string& key) {
+    LogRecord record;
+    record.op = LOG_DEL;
+    record.key = key;
+    return mutate(record);
+}
+
+bool LogStorage::incr(const std::string& key, long long& value) {
+    size_t shard = MemoryStorage::shardIndex(key);
+    std::lock_guard<std::mutex> lock(stripes[shard]);
+
+    // 空值不是整数，自增成功时previous为空即表示键原先不存在
+    std::string previous = index.get(key);
+    if (!index.incr(key, value)) {
+        return false;
+    }
+
+    // 日志中记录自增后的结果，重放时幂等
+    LogRecord record;
+    record.op = LOG_SET;
+    record.key = key;
+    record.value = std::to_string(value);
+    uint64_t lsn = append(record);
+    if (lsn == 0) {
+        restoreString(key, previous);
+        return false;
+    }
+    shardLsn[shard] = lsn;
+    return true;
+}
+
+bool LogStorage::hset(const std::string& key, const std::string& field, const std::string& value) {
+    LogRecord record;
+    record.op = LOG_HSET;
+    record.key = key;
+    record.field = field;
+    record.value = value;
+    return mutate(record);
+}
+
+std::string LogStorage::hget(const std::string& key, const std::string& field) {
+    return index.hget(key, field);
+}
+
+bool LogStorage::hexists(const std::string& key, const std::string& field) {
+    return index.hexists(key, field);
+}
+
+bool LogStorage::hdel(const std::string& key, const std::string& field) {
+    LogRecord record;
+    record.op = LOG_HDEL;
+    record.key = key;
+    record.field = field;
+    return mutate(record);
+}
+
+std::map<std::string, std::string> LogStorage::hgetall(const std::string& key) {
+    return index.hgetall(key);
+}
+
+bool LogStorage::hincrby(const std::string& key, const std::string& field, long long increment, long long& value) {
+    size_t shard = MemoryStorage::shardIndex(key);
+    std::lock_guard<std::mutex> lock(stripes[shard]);
+
+    std::string previous = index.hget(key, field);
+    if (!index.hincrby(key, field, increment, value)) {
+        return false;
+    }
+
+    // 与incr相同，日志中记录结果值；previous为空表示字段原先不存在
+    LogRecord record;
+    record.op = LOG_HSET;
+    record.key = key;
+    record.field = field;
+    record.value = std::to_string(value);
+    uint64_t lsn = append(record);
+    if (lsn == 0) {
+        restoreField(key, field, previous);
+        return false;
+    }
+    shardLsn[shard] = lsn;
+    return true;
+}
+
+bool LogStorage::hincrbyIfAtLeast(const std::string& key, const std::string& field, long long increment,
+                                  long long minimum, long long& value) {
+    size_t shard = MemoryStorage::shardIndex(key);
+    std::lock_guard<std::mutex> lock(stripes[shard]);
+
+    std::string previous = index.hget(key, field);
+    if (!index.hincrbyIfAtLeast(key, field, increment, minimum, value)) {
+        return false;
+    }
+
+    LogRecord record;
+    record.op = LOG_HSET;
+    record.key = key;
+    record.field = field;
+    record.value = std::to_string(value);
+    uint64_t lsn = append(record);
+    if (lsn == 0) {
+        restoreField(key, field, previous);
+        return false;
+    }
+    shardLsn[shard] = lsn;
+    return true;
+}
+
+bool LogStorage::hsetIfEqual(const std::string& key, const std::string& field, const std::string& expected,
+                             const std::string& value) {
+    size_t shard = MemoryStorage::shardIndex(key);
+    std::lock_guard<std::mutex> lock(stripes[shard]);
+
+    // 条带锁内该键不会被其他写入修改，比较后再写日志、改索引
+    if (!index.hexists(key, field) || index.hget(key, field) != expected) {
+        return false;
+    }
+
+    LogRecord record;
+    record.op = LOG_HSET;
+    record.key = key;
+    record.field = field;
+    record.value = value;
+    uint64_t lsn = append(record);
+    if (lsn == 0) {
+        return false;
+    }
+    index.hset(key, field, value);
+    shardLsn[shard] = lsn;
+    return true;
+}
+
+bool LogStorage::lpush(const std::string& key, const std::string& value) {
+    LogRecord record;
+    record.op = LOG_LPUSH;
+    record.key = key;
+    record.value = value;
+    return mutate(record);
+}
+
+bool LogStorage::rpush(const std::string& key, const std::string& value) {
+    LogRecord record;
+    record.op = LOG_RPUSH;
+    record.key = key;
+    record.value = value;
+    return mutate(record);
+}
+
+std::vector<std::string> LogStorage::lrange(const std::string& key, int start, int stop) {
+    return index.lrange(key, start, stop);
+}
+
+bool LogStorage::lset(const std::string& key, int position, const std::string& value) {
+    LogRecord record;
+    record.op = LOG_LSET;
+    record.key = key;
+    record.field = std::to_string(position);
+    record.value = value;
+    return mutate(record);
+}
+
+size_t LogStorage::llen(const std::string& key) {
+    return index.llen(key);
+}
+
+bool LogStorage::sync() {
+    return wal.sync();
+}
+
+std::string LogStorage::name() const {
+    return "local";
+}
@@ -0,0 +1,359 @@
+// MemoryStorage.cpp - Sharded in-memory storage following Redis semantics
+#include "MemoryStorage.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+
+MemoryStorage::MemoryStorage() {
+}
+
+size_t MemoryStorage::shardIndex(const std::string& key) {
+    // FNV-1a：与标准库实现无关，快照中记录的分片划分在不同构建之间保持稳定
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(hash & (SHARD_COUNT - 1));
+}
+
+bool MemoryStorage::parseInteger(const std::string& text, long long& value) {
+    // 与INCR/HINCRBY一致：只接受完整的64位十进制整数
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtoll(text.c_str(), &end, 10);
+    return !text.empty() && errno == 0 && end == text.c_str() + text.size();
+}
+
+MemoryStorage::Shard& MemoryStorage::shardFor(const std::string& key) {
+    return shards[shardIndex(key)];
+}
+
+bool MemoryStorage::connect() {
+    return true;
+}
+
+bool MemoryStorage::isConnected() const {
+    return true;
+}
+
+bool MemoryStorage::set(const std::string& key, const std::string& value) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // 与Redis一致：SET覆盖任意类型的旧值
+    shard.hashes.erase(key);
+    shard.lists.erase(key);
+    shard.strings[key] = value;
+    return true;
+}
+
+std::string MemoryStorage::get(const std::string& key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.strings.find(key);
+    if (it == shard.strings.end()) {
+        return "";
+    }
+    return it->second;
+}
+
+bool MemoryStorage::exists(const std::string& key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    return shard.strings.count(key) > 0 || shard.hashes.count(key) > 0 || shard.lists.count(key) > 0;
+}
+
+bool MemoryStorage::del(const std::string& key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    size_t removed = shard.strings.erase(key) + shard.hashes.erase(key) + shard.lists.erase(key);
+    return removed > 0;
+}
+
+bool MemoryStorage::incr(const std::string& key, long long& value) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (shard.hashes.count(key) > 0 || shard.lists.count(key) > 0) {
+        return false;
+    }
+
+    long long current = 0;
+    auto it = shard.strings.find(key);
+    if (it != shard.strings.end() && !parseInteger(it->second, current)) {
+        return false;
+    }
+    if (current == LLONG_MAX) {
+        return false;
+    }
+
+    value = current + 1;
+    shard.strings[key] = std::to_string(value);
+    return true;
+}
+
+bool MemoryStorage::hset(const std::string& key, const std::string& field, const std::string& value) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // 类型冲突（WRONGTYPE）
+    if (shard.strings.count(key) > 0 || shard.lists.count(key) > 0) {
+        return false;
+    }
+    shard.hashes[key][field] = value;
+    return true;
+}
+
+std::string MemoryStorage::hget(const std::string& key, const std::string& field) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.hashes.find(key);
+    if (it == shard.hashes.end()) {
+        return "";
+    }
+    auto field_it = it->second.find(field);
+    if (field_it == it->second.end()) {
+        return "";
+    }
+    return field_it->second;
+}
+
+bool MemoryStorage::hexists(const std::string& key, const std::string& field) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.hashes.find(key);
+    return it != shard.hashes.end() && it->second.count(field) > 0;
+}
+
+bool MemoryStorage::hdel(const std::string& key, const std::string& field) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.hashes.find(key);
+    if (it == shard.hashes.end() || it->second.erase(field) == 0) {
+        return false;
+    }
+    // 空哈希表自动删除
+    if (it->second.empty()) {
+        shard.hashes.erase(it);
+    }
+    return true;
+}
+
+std::map<std::string, std::string> MemoryStorage::hgetall(const std::string& key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.hashes.find(key);
+    if (it == shard.hashes.end()) {
+        return std::map<std::string, std::string>();
+    }
+    return it->second;
+}
+
+bool MemoryStorage::hincrby(const std::string& key, const std::string& field, long long increment, long long& value) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (shard.strings.count(key) > 0 || shard.lists.count(key) > 0) {
+        return false;
+    }
+
+    long long current = 0;
+    std::map<std::string, std::string>& fields = shard.hashes[key];
+    auto it = fields.find(field);
+    if (it != fields.end() && !parseInteger(it->second, current)) {
+        return false;
+    }
+    if ((increment > 0 && current > LLONG_MAX - increment) ||
+        (increment < 0 && current < LLONG_MIN - increment)) {
+        if (fields.empty()) {
+            shard.hashes.erase(key);
+        }
+        return false;
+    }
+
+    value = current + increment;
+    fields[field] = std::to_string(value);
+    return true;
+}
+
+bool MemoryStorage::hincrbyIfAtLeast(const std::string& key, const std::string& field, long long increment,
+                                     long long minimum, long long& value) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto hash = shard.hashes.find(key);
+    if (hash == shard.hashes.end()) {
+        return false;
+    }
+    auto it = hash->second.find(field);
+    long long current = 0;
+    if (it == hash->second.end() || !parseInteger(it->second, current)) {
+        return false;
+    }
+    if ((increment > 0 && current > LLONG_MAX - increment) ||
+        (increment < 0 && current < LLONG_MIN - increment) ||
+        current + increment < minimum) {
+        return false;
+    }
+
+    value = current + increment;
+    it->second = std::to_string(value);
+    return true;
+}
+
+bool MemoryStorage::hsetIfEqual(const std::string& key, const std::string& field, const std::string& expected,
+                                const std::string& value) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto hash = shard.hashes.find(key);
+    if (hash == shard.hashes.end()) {
+        return false;
+    }
+    auto it = hash->second.find(field);
+    if (it == hash->second.end() || it->second != expected) {
+        return false;
+    }
+    it->second = value;
+    return true;
+}
+
+bool MemoryStorage::lpush(const std::string& key, const std::string& value) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (shard.strings.count(key) > 0 || shard.hashes.count(key) > 0) {
+        return false;
+    }
+    shard.lists[key].push_front(value);
+    return true;
+}
+
+bool MemoryStorage::rpush(const std::string& key, const std::string& value) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (shard.strings.count(key) > 0 || shard.hashes.count(key) > 0) {
+        return false;
+    }
+    shard.lists[key].push_back(value);
+    return true;
+}
+
+std::vector<std::string> MemoryStorage::lrange(const std::string& key, int start, int stop) {
+    std::vector<std::string> result;
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.lists.find(key);
+    if (it == shard.lists.end()) {
+        return result;
+    }
+
+    // 与LRANGE相同的下标规则：负数表示从尾部计数，越界自动截断
+    const std::deque<std::string>& list = it->second;
+    long size = static_cast<long>(list.size());
+    long first = start < 0 ? size + start : start;
+    long last = stop < 0 ? size + stop : stop;
+    if (first < 0) {
+        first = 0;
+    }
+    if (last >= size) {
+        last = size - 1;
+    }
+    if (first > last) {
+        return result;
+    }
+
+    result.reserve(last - first + 1);
+    for (long i = first; i <= last; i++) {
+        result.push_back(list[i]);
+    }
+    return result;
+}
+
+bool MemoryStorage::lset(const std::string& key, int index, const std::string& value) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.lists.find(key);
+    if (it == shard.lists.end()) {
+        return false;
+    }
+
+    std::deque<std::string>& list = it->second;
+    long size = static_cast<long>(list.size());
+    long position = index < 0 ? size + index : index;
+    if (position < 0 || position >= size) {
+        return false;
+    }
+    list[position] = value;
+    return true;
+}
+
+std::string MemoryStorage::type(const std::string& key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (shard.strings.count(key) > 0) {
+        return "string";
+    }
+    if (shard.hashes.count(key) > 0) {
+        return "hash";
+    }
+    if (shard.lists.count(key) > 0) {
+        return "list";
+    }
+    return "none";
+}
+
+size_t MemoryStorage::llen(const std::string& key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.lists.find(key);
+    return it == shard.lists.end() ? 0 : it->second.size();
+}
+
+void MemoryStorage::visitShard(size_t index, Visitor& visitor) {
+    Shard& shard = shards[index];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    for (const auto& entry : shard.strings) {
+        visitor.onString(entry.first, entry.second);
+    }
+    for (const auto& entry : shard.hashes) {
+        visitor.onHash(entry.first, entry.second);
+    }
+    for (const auto& entry : shard.lists) {
+        visitor.onList(entry.first, entry.second);
+    }
+}
+
+void MemoryStorage::visit(Visitor& visitor) {
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        visitShard(i, visitor);
+    }
+}
+
+void MemoryStorage::clear() {
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        shards[i].strings.clear();
+        shards[i].hashes.clear();
+        shards[i].lists.clear();
+    }
+}
+
+std::string MemoryStorage::name() const {
+    return "memory";
+}
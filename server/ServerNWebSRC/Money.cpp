@@ -0,0 +1,112 @@
+// Money.cpp - Parsing, formatting and scaling of fixed-point amounts
+#include "Money.h"
+#include <cmath>
+#include <climits>
+
+const Money MoneyUtil::UNITS_PER_MAJOR;
+const Money MoneyUtil::MAX_AMOUNT;
+
+bool MoneyUtil::parse(const std::string& text, Money& amount) {
+    return parse(text.data(), text.size(), amount);
+}
+
+bool MoneyUtil::parse(const char* text, size_t n, Money& amount) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < n && (text[i] == '-' || text[i] == '+')) {
+        negative = text[i] == '-';
+        i++;
+    }
+
+    Money major = 0;
+    size_t digits = 0;
+    for (; i < n && text[i] >= '0' && text[i] <= '9'; i++, digits++) {
+        major = major * 10 + (text[i] - '0');
+        if (major > MAX_AMOUNT / UNITS_PER_MAJOR) {
+            return false;
+        }
+    }
+
+    Money minor = 0;
+    if (i < n && text[i] == '.') {
+        i++;
+        size_t fraction = 0;
+        for (; i < n && text[i] >= '0' && text[i] <= '9'; i++, fraction++, digits++) {
+            if (fraction < 2) {
+                minor = minor * 10 + (text[i] - '0');
+            }
+            else if (text[i] != '0') {
+                return false;  // 不足一分的金额
+            }
+        }
+        if (fraction == 1) {
+            minor *= 10;
+        }
+    }
+
+    if (digits == 0 || i != n) {
+        return false;
+    }
+    amount = major * UNITS_PER_MAJOR + minor;
+    if (negative) {
+        amount = -amount;
+    }
+    return true;
+}
+
+std::string MoneyUtil::format(Money amount) {
+    std::string out;
+    append(out, amount);
+    return out;
+}
+
+void MoneyUtil::append(std::string& out, Money amount) {
+    // 从低位向前填充，不经过printf/iostream
+    uint64_t magnitude = amount < 0 ? 0 - static_cast<uint64_t>(amount) : static_cast<uint64_t>(amount);
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* p = end;
+
+    uint64_t cents = magnitude % UNITS_PER_MAJOR;
+    magnitude /= UNITS_PER_MAJOR;
+    *--p = static_cast<char>('0' + cents % 10);
+    *--p = static_cast<char>('0' + cents / 10);
+    *--p = '.';
+    do {
+        *--p = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (amount < 0) {
+        *--p = '-';
+    }
+    out.append(p, end - p);
+}
+
+Money MoneyUtil::fromDouble(double amount) {
+    double units = amount * UNITS_PER_MAJOR;
+    if (!(std::fabs(units) <= static_cast<double>(MAX_AMOUNT))) {
+        return 0;
+    }
+    return std::llround(units);
+}
+
+Money MoneyUtil::scale(Money amount, int64_t numerator, int64_t denominator) {
+    if (denominator <= 0) {
+        return 0;
+    }
+    // 先除后乘：整数部分与余数分别计算，避免 amount * numerator 溢出
+    Money whole = amount / denominator;
+    Money rest = amount % denominator;
+    Money bound = whole < 0 ? -whole : whole;
+    if (bound < denominator) {
+        bound = denominator;
+    }
+    if (numerator > LLONG_MAX / bound || numerator < -(LLONG_MAX / bound)) {
+        return (amount < 0) != (numerator < 0) ? -MAX_AMOUNT : MAX_AMOUNT;
+    }
+
+    Money partial = rest * numerator;
+    Money half = denominator / 2;
+    Money rounded = (partial >= 0 ? partial + half : partial - half) / denominator;
+    return whole * numerator + rounded;
+}
@@ -0,0 +1,65 @@
+// RecordConverter.cpp - Implementation of the background record converter
+#include "RecordConverter.h"
+#include "AccountManager.h"
+#include "TransactionManager.h"
+#include "DepositManager.h"
+#include <chrono>
+#include <iostream>
+
+RecordConverter::RecordConverter(StorageBackend& storage, TransactionManager& tm, DepositManager& dm,
+                                 unsigned recordsPerSecond)
+    : storage(storage), transactionManager(tm), depositManager(dm),
+      recordsPerSecond(recordsPerSecond), stopping(false) {
+}
+
+RecordConverter::~RecordConverter() {
+    stop();
+}
+
+void RecordConverter::start() {
+    if (thread.joinable() || recordsPerSecond == 0) {
+        return;
+    }
+    stopping = false;
+    thread = std::thread(&RecordConverter::run, this);
+}
+
+void RecordConverter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_one();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+bool RecordConverter::throttle(size_t records) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (records > 0) {
+        std::chrono::microseconds delay(static_cast<long long>(records) * 1000000 / recordsPerSecond);
+        wakeup.wait_for(lock, delay, [this]() { return stopping; });
+    }
+    return !stopping;
+}
+
+void RecordConverter::run() {
+    std::vector<std::string> usernames = storage.lrange(AccountManager::getUsersListKey(), 0, -1);
+    size_t users = 0;
+    size_t records = 0;
+    for (const auto& username : usernames) {
+        size_t converted = transactionManager.upgradeTransactions(username) + depositManager.upgradeDeposits(username);
+        if (converted > 0) {
+            users++;
+            records += converted;
+        }
+        if (!throttle(converted)) {
+            std::cout << "Record conversion stopped: " << records << " records of " << users << " users rewritten"
+                      << std::endl;
+            return;
+        }
+    }
+    std::cout << "Record conversion finished: " << records << " records of " << users << " users rewritten"
+              << std::endl;
+}
@@ -1,5 +1,8 @@
 #include "RedisClient.h"
+#include "StorageBackend.h"
 #include <iostream>
+#include <cstring>
+#include <sys/socket.h>
 
 RedisClient::RedisClient(const std::string& host, int port, const std::string& password)
     : context(nullptr), host(host), port(port), password(password) {
@@ -72,7 +75,7 @@ bool RedisClient::set(const std::string& key, const std::string& value) {
         return false;
     }
     
-    redisReply* reply = (redisReply*)redisCommand(context, "SET %s %s", key.c_str(), value.c_str());
+    redisReply* reply = (redisReply*)redisCommand(context, "SET %s %b", key.c_str(), value.data(), value.size());
     if (reply == nullptr) {
         std::cerr << "Redis SET命令错误: 无法获取回复" << std::endl;
         return false;
@@ -98,7 +101,7 @@ std::string RedisClient::get(const std::string& key) {
     
     std::string value;
     if (reply->type == REDIS_REPLY_STRING) {
-        value = reply->str;
+        value.assign(reply->str, reply->len);
     }
     
     freeReply(reply);
@@ -141,14 +144,35 @@ bool RedisClient::del(const std::string& key) {
     return success;
 }
 
+bool RedisClient::incr(const std::string& key, long long& value) {
+    if (!isConnected()) {
+        std::cerr << "Redis未连接" << std::endl;
+        return false;
+    }
+    
+    redisReply* reply = (redisReply*)redisCommand(context, "INCR %s", key.c_str());
+    if (reply == nullptr) {
+        std::cerr << "Redis INCR命令错误: 无法获取回复" << std::endl;
+        return false;
+    }
+    
+    bool success = (reply->type == REDIS_REPLY_INTEGER);
+    if (success) {
+        value = reply->integer;
+    }
+    freeReply(reply);
+    
+    return success;
+}
+
 bool RedisClient::hset(const std::string& key, const std::string& field, const std::string& value) {
     if (!isConnected()) {
         std::cerr << "Redis未连接" << std::endl;
         return false;
     }
     
-    redisReply* reply = (redisReply*)redisCommand(context, "HSET %s %s %s", 
-                                              key.c_str(), field.c_str(), value.c_str());
+    redisReply* reply = (redisReply*)redisCommand(context, "HSET %s %s %b",
+                                              key.c_str(), field.c_str(), value.data(), value.size());
     if (reply == nullptr) {
         std::cerr << "Redis HSET命令错误: 无法获取回复" << std::endl;
         return false;
@@ -174,7 +198,7 @@ std::string RedisClient::hget(const std::string& key, const std::string& field)
     
     std::string value;
     if (reply->type == REDIS_REPLY_STRING) {
-        value = reply->str;
+        value.assign(reply->str, reply->len);
     }
     
     freeReply(reply);
@@ -234,9 +258,8 @@ std::map<std::string, std::string> RedisClient::hgetall(const std::string& key)
     if (reply->type == REDIS_REPLY_ARRAY) {
         for (size_t i = 0; i < reply->elements; i += 2) {
             if (i + 1 < reply->elements) {
-                std::string field = reply->element[i]->str;
-                std::string value = reply->element[i + 1]->str;
-                result[field] = value;
+                result[std::string(reply->element[i]->str, reply->element[i]->len)] =
+                    std::string(reply->element[i + 1]->str, reply->element[i + 1]->len);
             }
         }
     }
@@ -245,13 +268,87 @@ std::map<std::string, std::string> RedisClient::hgetall(const std::string& key)
     return result;
 }
 
+bool RedisClient::hincrby(const std::string& key, const std::string& field, long long increment, long long& value) {
+    if (!isConnected()) {
+        std::cerr << "Redis未连接" << std::endl;
+        return false;
+    }
+    
+    redisReply* reply = (redisReply*)redisCommand(context, "HINCRBY %s %s %lld", key.c_str(), field.c_str(), increment);
+    if (reply == nullptr) {
+        std::cerr << "Redis HINCRBY命令错误: 无法获取回复" << std::endl;
+        return false;
+    }
+    
+    bool success = (reply->type == REDIS_REPLY_INTEGER);
+    if (success) {
+        value = reply->integer;
+    }
+    freeReply(reply);
+    
+    return success;
+}
+
+bool RedisClient::hincrbyIfAtLeast(const std::string& key, const std::string& field, long long increment,
+                                   long long minimum, long long& value) {
+    if (!isConnected()) {
+        std::cerr << "Redis未连接" << std::endl;
+        return false;
+    }
+    
+    // 检查与增减在同一脚本内执行，期间不会穿插其他客户端的命令
+    redisReply* reply = (redisReply*)redisCommand(context, "EVAL %s 1 %s %s %lld %lld", HINCRBY_IF_AT_LEAST_SCRIPT,
+                                                  key.c_str(), field.c_str(), increment, minimum);
+    if (reply == nullptr) {
+        std::cerr << "Redis EVAL命令错误: 无法获取回复" << std::endl;
+        return false;
+    }
+    
+    // 空回复表示字段不存在或结果低于下限，属于正常拒绝
+    bool success = (reply->type == REDIS_REPLY_INTEGER);
+    if (success) {
+        value = reply->integer;
+    }
+    else if (reply->type == REDIS_REPLY_ERROR) {
+        std::cerr << "Redis EVAL命令错误: " << std::string(reply->str, reply->len) << std::endl;
+    }
+    freeReply(reply);
+    
+    return success;
+}
+
+bool RedisClient::hsetIfEqual(const std::string& key, const std::string& field, const std::string& expected,
+                              const std::string& value) {
+    if (!isConnected()) {
+        std::cerr << "Redis未连接" << std::endl;
+        return false;
+    }
+    
+    // 记录可能是含\0的二进制编码，旧值和新值都按长度传递
+    redisReply* reply = (redisReply*)redisCommand(context, "EVAL %s 1 %s %s %b %b", HSET_IF_EQUAL_SCRIPT,
+                                                  key.c_str(), field.c_str(), expected.data(), expected.size(),
+                                                  value.data(), value.size());
+    if (reply == nullptr) {
+        std::cerr << "Redis EVAL命令错误: 无法获取回复" << std::endl;
+        return false;
+    }
+    
+    bool success = (reply->type == REDIS_REPLY_INTEGER && reply->integer == 1);
+    if (reply->type == REDIS_REPLY_ERROR) {
+        std::cerr << "Redis EVAL命令错误: " << std::string(reply->str, reply->len) << std::endl;
+    }
+    freeReply(reply);
+    
+    return success;
+}
+
 bool RedisClient::lpush(const std::string& key, const std::string& value) {
     if (!isConnected()) {
         std::cerr << "Redis未连接" << std::endl;
         return false;
     }
     
-    redisReply* reply = (redisReply*)redisCommand(context, "LPUSH %s %s", key.c_str(), value.c_str());
+    redisReply* reply = (redisReply*)redisCommand(context, "LPUSH %s %b", key.c_str(), value.data(), value.size());
     if (reply == nullptr) {
         std::cerr << "Redis LPUSH命令错误: 无法获取回复" << std::endl;
         return false;
@@ -269,7 +366,7 @@ bool RedisClient::rpush(const std::string& key, const std::string& value) {
         return false;
     }
     
-    redisReply* reply = (redisReply*)redisCommand(context, "RPUSH %s %s", key.c_str(), value.c_str());
+    redisReply* reply = (redisReply*)redisCommand(context, "RPUSH %s %b", key.c_str(), value.data(), value.size());
     if (reply == nullptr) {
         std::cerr << "Redis RPUSH命令错误: 无法获取回复" << std::endl;
         return false;
@@ -297,7 +394,7 @@ std::vector<std::string> RedisClient::lrange(const std::string& key, int start,
     
     if (reply->type == REDIS_REPLY_ARRAY) {
         for (size_t i = 0; i < reply->elements; i++) {
-            result.push_back(reply->element[i]->str);
+            result.push_back(std::string(reply->element[i]->str, reply->element[i]->len));
         }
     }
     
@@ -305,6 +402,45 @@ std::vector<std::string> RedisClient::lrange(const std::string& key, int start,
     return result;
 }
 
+bool RedisClient::lset(const std::string& key, int index, const std::string& value) {
+    if (!isConnected()) {
+        std::cerr << "Redis未连接" << std::endl;
+        return false;
+    }
+    
+    redisReply* reply = (redisReply*)redisCommand(context, "LSET %s %d %b", key.c_str(), index, value.data(), value.size());
+    if (reply == nullptr) {
+        std::cerr << "Redis LSET命令错误: 无法获取回复" << std::endl;
+        return false;
+    }
+    
+    bool success = (reply->type != REDIS_REPLY_ERROR);
+    freeReply(reply);
+    
+    return success;
+}
+
+size_t RedisClient::llen(const std::string& key) {
+    if (!isConnected()) {
+        std::cerr << "Redis未连接" << std::endl;
+        return 0;
+    }
+    
+    redisReply* reply = (redisReply*)redisCommand(context, "LLEN %s", key.c_str());
+    if (reply == nullptr) {
+        std::cerr << "Redis LLEN命令错误: 无法获取回复" << std::endl;
+        return 0;
+    }
+    
+    size_t length = 0;
+    if (reply->type == REDIS_REPLY_INTEGER && reply->integer > 0) {
+        length = static_cast<size_t>(reply->integer);
+    }
+    freeReply(reply);
+    
+    return length;
+}
+
 bool RedisClient::multi() {
     if (!isConnected()) {
         std::cerr << "Redis未连接" << std::endl;
@@ -395,6 +531,95 @@ bool RedisClient::flushdb() {
     return success;
 }
 
+bool RedisClient::enableTracking(const std::vector<std::string>& prefixes) {
+    if (!isConnected()) {
+        std::cerr << "Redis未连接" << std::endl;
+        return false;
+    }
+
+#ifdef REDIS_REPLY_PUSH
+    redisReply* reply = (redisReply*)redisCommand(context, "HELLO 3");
+    if (reply == nullptr || reply->type == REDIS_REPLY_ERROR) {
+        std::cerr << "Redis HELLO 3失败（需要Redis 6+）" << std::endl;
+        freeReply(reply);
+        return false;
+    }
+    freeReply(reply);
+
+    // 不设置推送回调，失效通知通过redisGetReply返回
+    redisSetPushCallback(context, nullptr);
+
+    std::vector<std::string> args;
+    args.push_back("CLIENT");
+    args.push_back("TRACKING");
+    args.push_back("on");
+    args.push_back("BCAST");
+    for (const auto& prefix : prefixes) {
+        args.push_back("PREFIX");
+        args.push_back(prefix);
+    }
+    std::vector<const char*> argv;
+    std::vector<size_t> argvlen;
+    for (const auto& arg : args) {
+        argv.push_back(arg.data());
+        argvlen.push_back(arg.size());
+    }
+
+    reply = (redisReply*)redisCommandArgv(context, static_cast<int>(argv.size()), argv.data(), argvlen.data());
+    if (reply == nullptr || reply->type == REDIS_REPLY_ERROR) {
+        std::cerr << "Redis CLIENT TRACKING失败" << (reply ? std::string(": ") + reply->str : "") << std::endl;
+        freeReply(reply);
+        return false;
+    }
+    freeReply(reply);
+    return true;
+#else
+    (void)prefixes;
+    std::cerr << "hiredis版本过旧，不支持RESP3客户端缓存" << std::endl;
+    return false;
+#endif
+}
+
+bool RedisClient::readInvalidation(std::vector<std::string>& keys) {
+    keys.clear();
+    if (!isConnected()) {
+        return false;
+    }
+
+#ifdef REDIS_REPLY_PUSH
+    while (true) {
+        redisReply* reply = nullptr;
+        if (redisGetReply(context, (void**)&reply) != REDIS_OK || reply == nullptr) {
+            return false;
+        }
+
+        // 失效通知格式: >2 "invalidate" [key ...] 或 >2 "invalidate" (nil)
+        bool invalidate = reply->type == REDIS_REPLY_PUSH && reply->elements >= 2 &&
+            reply->element[0]->str != nullptr && strcmp(reply->element[0]->str, "invalidate") == 0;
+        if (invalidate) {
+            redisReply* list = reply->element[1];
+            if (list->type == REDIS_REPLY_ARRAY || list->type == REDIS_REPLY_SET) {
+                for (size_t i = 0; i < list->elements; i++) {
+                    keys.push_back(std::string(list->element[i]->str, list->element[i]->len));
+                }
+            }
+        }
+        freeReply(reply);
+        if (invalidate) {
+            return true;
+        }
+    }
+#else
+    return false;
+#endif
+}
+
+void RedisClient::interrupt() {
+    if (context != nullptr && context->fd >= 0) {
+        ::shutdown(context->fd, SHUT_RDWR);
+    }
+}
+
 std::string RedisClient::getLastError() const {
     if (context && context->err) {
         return context->errstr;
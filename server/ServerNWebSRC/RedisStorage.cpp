@@ -0,0 +1,216 @@
+// RedisStorage.cpp - Redis-backed storage with a small connection pool
+#include "RedisStorage.h"
+#include <iostream>
+#include <chrono>
+
+namespace {
+
+// 失效通知连接断开后的重连间隔
+const std::chrono::seconds TRACKING_RETRY_INTERVAL(1);
+
+} // namespace
+
+RedisStorage::RedisStorage(const std::string& host, int port, const std::string& password, int poolSize)
+    : nextConnection(0), host(host), port(port), password(password), trackingStopping(false) {
+    if (poolSize < 1) {
+        poolSize = 1;
+    }
+    for (int i = 0; i < poolSize; i++) {
+        pool.push_back(std::unique_ptr<Connection>(new Connection(host, port, password)));
+    }
+}
+
+RedisStorage::~RedisStorage() {
+    trackingStopping = true;
+    {
+        std::lock_guard<std::mutex> lock(trackingMutex);
+        if (trackingClient) {
+            trackingClient->interrupt();
+        }
+    }
+    if (trackingThread.joinable()) {
+        trackingThread.join();
+    }
+}
+
+RedisStorage::Connection& RedisStorage::acquire() {
+    return *pool[nextConnection.fetch_add(1) % pool.size()];
+}
+
+bool RedisStorage::connect() {
+    for (auto& conn : pool) {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        if (!conn->client.connect()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RedisStorage::isConnected() const {
+    for (const auto& conn : pool) {
+        if (!conn->client.isConnected()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RedisStorage::set(const std::string& key, const std::string& value) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.set(key, value);
+}
+
+std::string RedisStorage::get(const std::string& key) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.get(key);
+}
+
+bool RedisStorage::exists(const std::string& key) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.exists(key);
+}
+
+bool RedisStorage::del(const std::string& key) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.del(key);
+}
+
+bool RedisStorage::incr(const std::string& key, long long& value) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.incr(key, value);
+}
+
+bool RedisStorage::hset(const std::string& key, const std::string& field, const std::string& value) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.hset(key, field, value);
+}
+
+std::string RedisStorage::hget(const std::string& key, const std::string& field) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.hget(key, field);
+}
+
+bool RedisStorage::hexists(const std::string& key, const std::string& field) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.hexists(key, field);
+}
+
+bool RedisStorage::hdel(const std::string& key, const std::string& field) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.hdel(key, field);
+}
+
+std::map<std::string, std::string> RedisStorage::hgetall(const std::string& key) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.hgetall(key);
+}
+
+bool RedisStorage::hincrby(const std::string& key, const std::string& field, long long increment, long long& value) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.hincrby(key, field, increment, value);
+}
+
+bool RedisStorage::hincrbyIfAtLeast(const std::string& key, const std::string& field, long long increment,
+                                    long long minimum, long long& value) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.hincrbyIfAtLeast(key, field, increment, minimum, value);
+}
+
+bool RedisStorage::hsetIfEqual(const std::string& key, const std::string& field, const std::string& expected,
+                               const std::string& value) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.hsetIfEqual(key, field, expected, value);
+}
+
+bool RedisStorage::lpush(const std::string& key, const std::string& value) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.lpush(key, value);
+}
+
+bool RedisStorage::rpush(const std::string& key, const std::string& value) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.rpush(key, value);
+}
+
+std::vector<std::string> RedisStorage::lrange(const std::string& key, int start, int stop) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.lrange(key, start, stop);
+}
+
+bool RedisStorage::lset(const std::string& key, int index, const std::string& value) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.lset(key, index, value);
+}
+
+size_t RedisStorage::llen(const std::string& key) {
+    Connection& conn = acquire();
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    return conn.client.llen(key);
+}
+
+bool RedisStorage::subscribeInvalidations(const std::vector<std::string>& prefixes, InvalidationCallback callback) {
+    if (trackingThread.joinable()) {
+        std::cerr << "Redis失效通知已订阅" << std::endl;
+        return false;
+    }
+
+    trackingPrefixes = prefixes;
+    trackingCallback = callback;
+    if (!connectTracking()) {
+        return false;
+    }
+    trackingThread = std::thread(&RedisStorage::trackingLoop, this);
+    return true;
+}
+
+bool RedisStorage::connectTracking() {
+    std::unique_ptr<RedisClient> client(new RedisClient(host, port, password));
+    if (!client->connect() || !client->enableTracking(trackingPrefixes)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(trackingMutex);
+    trackingClient.swap(client);
+    return true;
+}
+
+void RedisStorage::trackingLoop() {
+    std::vector<std::string> keys;
+    while (!trackingStopping) {
+        if (trackingClient->readInvalidation(keys)) {
+            trackingCallback(keys);
+            continue;
+        }
+        if (trackingStopping) {
+            break;
+        }
+
+        // 连接中断期间可能错过通知，全部失效后重连
+        std::cerr << "Redis失效通知连接中断，正在重连" << std::endl;
+        trackingCallback(std::vector<std::string>());
+        while (!trackingStopping && !connectTracking()) {
+            std::this_thread::sleep_for(TRACKING_RETRY_INTERVAL);
+        }
+    }
+}
+
+std::string RedisStorage::name() const {
+    return "redis";
+}
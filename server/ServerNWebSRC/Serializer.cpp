@@ -1,124 +1,755 @@
 #include "Serializer.h"
-#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <cstdint>
+#include <atomic>
+
+// x86上用SSE2（x86-64基线指令集）和AVX2（运行时检测）扫描分隔符
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SERIALIZER_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const char FIELD_SEPARATOR = '|';
+
+// 在[p, end)上按分隔符依次取字段，不复制数据
+class FieldReader {
+private:
+    const char* p;
+    const char* end;
+    bool done;
+
+public:
+    FieldReader(const char* data, size_t len) : p(data), end(data + len), done(false) {}
+
+    // 取下一个字段；没有剩余字段时返回false
+    bool next(const char*& field, size_t& len) {
+        if (done) {
+            return false;
+        }
+        const char* separator = static_cast<const char*>(memchr(p, FIELD_SEPARATOR, end - p));
+        field = p;
+        if (separator == nullptr) {
+            len = end - p;
+            done = true;
+        }
+        else {
+            len = separator - p;
+            p = separator + 1;
+        }
+        return true;
+    }
+};
+
+// 记录分隔符的位置依次写入offsets，最多maxOffsets个，返回找到的个数
+typedef size_t (*SeparatorScanner)(const char* data, size_t len, size_t* offsets, size_t maxOffsets);
+
+size_t scanSeparatorsFrom(const char* data, size_t pos, size_t len, size_t* offsets, size_t count, size_t maxOffsets) {
+    for (; pos < len && count < maxOffsets; pos++) {
+        if (data[pos] == FIELD_SEPARATOR) {
+            offsets[count++] = pos;
+        }
+    }
+    return count;
+}
+
+size_t scanSeparatorsScalar(const char* data, size_t len, size_t* offsets, size_t maxOffsets) {
+    return scanSeparatorsFrom(data, 0, len, offsets, 0, maxOffsets);
+}
+
+#ifdef SERIALIZER_X86_SIMD
+__attribute__((target("sse2")))
+size_t scanSeparatorsSse2(const char* data, size_t len, size_t* offsets, size_t maxOffsets) {
+    const __m128i separator = _mm_set1_epi8(FIELD_SEPARATOR);
+    size_t count = 0;
+    size_t pos = 0;
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, separator)));
+        // 每个置位对应块内一个分隔符
+        while (mask != 0) {
+            offsets[count++] = pos + __builtin_ctz(mask);
+            if (count == maxOffsets) {
+                return count;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return scanSeparatorsFrom(data, pos, len, offsets, count, maxOffsets);
+}
+
+__attribute__((target("avx2")))
+size_t scanSeparatorsAvx2(const char* data, size_t len, size_t* offsets, size_t maxOffsets) {
+    const __m256i separator = _mm256_set1_epi8(FIELD_SEPARATOR);
+    size_t count = 0;
+    size_t pos = 0;
+    for (; pos + 32 <= len; pos += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, separator)));
+        while (mask != 0) {
+            offsets[count++] = pos + __builtin_ctz(mask);
+            if (count == maxOffsets) {
+                return count;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return scanSeparatorsFrom(data, pos, len, offsets, count, maxOffsets);
+}
+#endif
+
+struct ScannerEntry {
+    const char* name;
+    SeparatorScanner scan;
+    bool (*supported)();
+};
+
+bool alwaysSupported() {
+    return true;
+}
+
+#ifdef SERIALIZER_X86_SIMD
+bool cpuHasSse2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+bool cpuHasAvx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+// 按优先级排列，选择第一个CPU支持的实现
+const ScannerEntry SCANNERS[] = {
+#ifdef SERIALIZER_X86_SIMD
+    { "avx2", &scanSeparatorsAvx2, &cpuHasAvx2 },
+    { "sse2", &scanSeparatorsSse2, &cpuHasSse2 },
+#endif
+    { "scalar", &scanSeparatorsScalar, &alwaysSupported }
+};
+
+// 首次使用时选定（常量初始化为空，不受静态初始化顺序影响）
+std::atomic<const ScannerEntry*> activeScanner(nullptr);
+
+const ScannerEntry& separatorScannerEntry() {
+    const ScannerEntry* entry = activeScanner.load(std::memory_order_acquire);
+    if (entry == nullptr) {
+        for (const ScannerEntry& candidate : SCANNERS) {
+            if (candidate.supported()) {
+                entry = &candidate;
+                break;
+            }
+        }
+        activeScanner.store(entry, std::memory_order_release);
+    }
+    return *entry;
+}
+
+bool parseInteger(const char* text, size_t len, long long& value) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < len && (text[i] == '-' || text[i] == '+')) {
+        negative = text[i] == '-';
+        i++;
+    }
+    if (i == len) {
+        return false;
+    }
+
+    unsigned long long magnitude = 0;
+    const unsigned long long limit = negative ? static_cast<unsigned long long>(LLONG_MAX) + 1 : LLONG_MAX;
+    for (; i < len; i++) {
+        unsigned digit = static_cast<unsigned char>(text[i]) - '0';
+        if (digit > 9 || magnitude > (limit - digit) / 10) {
+            return false;
+        }
+        magnitude = magnitude * 10 + digit;
+    }
+    value = negative ? static_cast<long long>(0 - magnitude) : static_cast<long long>(magnitude);
+    return true;
+}
+
+bool parseInt(const char* text, size_t len, int& value) {
+    long long parsed = 0;
+    if (!parseInteger(text, len, parsed) || parsed < INT_MIN || parsed > INT_MAX) {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+void appendInteger(std::string& out, long long value) {
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* p = end;
+    unsigned long long magnitude = value < 0 ? 0 - static_cast<unsigned long long>(value) : value;
+    do {
+        *--p = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) {
+        *--p = '-';
+    }
+    out.append(p, end - p);
+}
+
+// 二进制编码：无符号LEB128变长整数，有符号数先做zigzag变换
+void appendVarint(std::string& out, uint64_t value) {
+    char buffer[10];
+    size_t n = 0;
+    while (value >= 0x80) {
+        buffer[n++] = static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    buffer[n++] = static_cast<char>(value);
+    out.append(buffer, n);
+}
+
+void appendSigned(std::string& out, int64_t value) {
+    appendVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+// 金额固定8字节小端
+void appendMoney(std::string& out, Money amount) {
+    uint64_t bits = static_cast<uint64_t>(amount);
+    char buffer[8];
+    for (size_t i = 0; i < 8; i++) {
+        buffer[i] = static_cast<char>(bits >> (8 * i));
+    }
+    out.append(buffer, 8);
+}
+
+void appendBytes(std::string& out, const std::string& value) {
+    appendVarint(out, value.size());
+    out.append(value);
+}
+
+class BinaryReader {
+private:
+    const unsigned char* p;
+    const unsigned char* end;
+
+public:
+    BinaryReader(const char* data, size_t len)
+        : p(reinterpret_cast<const unsigned char*>(data)), end(reinterpret_cast<const unsigned char*>(data) + len) {}
+
+    bool atEnd() const { return p == end; }
+
+    bool byte(unsigned char& value) {
+        if (p == end) {
+            return false;
+        }
+        value = *p++;
+        return true;
+    }
+
+    bool varint(uint64_t& value) {
+        value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (p == end) {
+                return false;
+            }
+            unsigned char b = *p++;
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool signedVarint(int64_t& value) {
+        uint64_t raw = 0;
+        if (!varint(raw)) {
+            return false;
+        }
+        value = static_cast<int64_t>((raw >> 1) ^ (0 - (raw & 1)));
+        return true;
+    }
+
+    bool integer(int& value) {
+        uint64_t raw = 0;
+        if (!varint(raw) || raw > INT_MAX) {
+            return false;
+        }
+        value = static_cast<int>(raw);
+        return true;
+    }
+
+    bool money(Money& amount) {
+        if (end - p < 8) {
+            return false;
+        }
+        uint64_t bits = 0;
+        for (size_t i = 0; i < 8; i++) {
+            bits |= static_cast<uint64_t>(p[i]) << (8 * i);
+        }
+        p += 8;
+        amount = static_cast<Money>(bits);
+        return true;
+    }
+
+    bool bytes(std::string& value) {
+        uint64_t len = 0;
+        if (!varint(len) || len > static_cast<uint64_t>(end - p)) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(p), static_cast<size_t>(len));
+        p += len;
+        return true;
+    }
+};
+
+} // namespace
+
+const unsigned char Serializer::BINARY_VERSION;
+const int Serializer::TEXT_SCHEMA;
+
+// 新增格式版本时在此登记；不再登记的版本将无法读取，需先由后台转换完成升级
+const Serializer::Schema Serializer::SCHEMAS[] = {
+    { TEXT_SCHEMA, "text", &Serializer::decodeUserText, &Serializer::decodeTransactionText, &Serializer::decodeDepositText },
+    { BINARY_VERSION, "binary-v1", &Serializer::decodeUserBinary, &Serializer::decodeTransactionBinary,
+      &Serializer::decodeDepositBinary }
+};
+
+bool Serializer::isBinary(const char* data, size_t len) {
+    return len > 0 && static_cast<unsigned char>(data[0]) < 0x20;
+}
+
+const char* Serializer::separatorScanner() {
+    return separatorScannerEntry().name;
+}
+
+bool Serializer::useSeparatorScanner(const std::string& name) {
+    for (const ScannerEntry& candidate : SCANNERS) {
+        if (name == candidate.name) {
+            if (!candidate.supported()) {
+                return false;
+            }
+            activeScanner.store(&candidate, std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+const Serializer::Schema* Serializer::findSchema(const char* data, size_t len) {
+    if (len == 0) {
+        return nullptr;
+    }
+    int version = isBinary(data, len) ? static_cast<unsigned char>(data[0]) : TEXT_SCHEMA;
+    for (const Schema& schema : SCHEMAS) {
+        if (schema.version == version) {
+            return &schema;
+        }
+    }
+    return nullptr;
+}
+
+int Serializer::schemaVersion(const char* data, size_t len) {
+    const Schema* schema = findSchema(data, len);
+    return schema == nullptr ? -1 : schema->version;
+}
+
+int Serializer::currentSchema(RecordFormat format) {
+    return format == RECORD_FORMAT_BINARY ? BINARY_VERSION : TEXT_SCHEMA;
+}
+
+bool Serializer::needsUpgrade(const char* data, size_t len, RecordFormat format) {
+    int version = schemaVersion(data, len);
+    return version >= 0 && version != currentSchema(format);
+}
+
+bool Serializer::parseRecordFormat(const std::string& name, RecordFormat& format) {
+    if (name == "text") {
+        format = RECORD_FORMAT_TEXT;
+        return true;
+    }
+    if (name == "binary") {
+        format = RECORD_FORMAT_BINARY;
+        return true;
+    }
+    return false;
+}
+
+bool Serializer::parseAmount(const char* text, size_t len, Money& amount) {
+    if (MoneyUtil::parse(text, len, amount)) {
+        return true;
+    }
+
+    // 旧格式如 "1.23457e+06"
+    char buffer[64];
+    if (len == 0 || len >= sizeof(buffer)) {
+        return false;
+    }
+    memcpy(buffer, text, len);
+    buffer[len] = '\0';
+    char* end = nullptr;
+    double value = std::strtod(buffer, &end);
+    if (end != buffer + len) {
+        return false;
+    }
+    amount = MoneyUtil::fromDouble(value);
+    return true;
+}
 
 // 序列化和反序列化用户对象
-std::string Serializer::serializeUser(const User& user) {
-    std::ostringstream ss;
-    ss << user.username << "|"
-       << user.password << "|"
-       << static_cast<int>(user.type) << "|"
-       << user.balance;
-    
-    return ss.str();
+std::string Serializer::serializeUser(const User& user, RecordFormat format) {
+    std::string out;
+    appendUser(user, out, format);
+    return out;
+}
+
+void Serializer::appendUser(const User& user, std::string& out, RecordFormat format) {
+    if (format == RECORD_FORMAT_BINARY) {
+        appendUserBinary(user, out);
+        return;
+    }
+    out.append(user.username);
+    out += FIELD_SEPARATOR;
+    out.append(user.password);
+    out += FIELD_SEPARATOR;
+    appendInteger(out, static_cast<int>(user.type));
+    out += FIELD_SEPARATOR;
+    MoneyUtil::append(out, user.balance);
 }
 
 User Serializer::deserializeUser(const std::string& data) {
     User user;
-    std::istringstream ss(data);
-    std::string token;
-    
-    // 使用'|'作为分隔符获取数据
-    std::getline(ss, user.username, '|');
-    std::getline(ss, user.password, '|');
-    
-    std::string typeStr;
-    std::getline(ss, typeStr, '|');
-    user.type = static_cast<AccountType>(std::stoi(typeStr));
-    
-    std::string balanceStr;
-    std::getline(ss, balanceStr, '|');
-    user.balance = std::stod(balanceStr);
-    
+    if (!deserializeUser(data.data(), data.size(), user)) {
+        return User();
+    }
     return user;
 }
 
+bool Serializer::deserializeUser(const char* data, size_t len, User& user) {
+    const Schema* schema = findSchema(data, len);
+    return schema != nullptr && schema->decodeUser(data, len, user);
+}
+
+bool Serializer::decodeUserText(const char* data, size_t len, User& user) {
+    FieldReader reader(data, len);
+    const char* field;
+    size_t size;
+    int type = 0;
+
+    if (!reader.next(field, size)) {
+        return false;
+    }
+    user.username.assign(field, size);
+    if (!reader.next(field, size)) {
+        return false;
+    }
+    user.password.assign(field, size);
+    if (!reader.next(field, size) || !parseInt(field, size, type)) {
+        return false;
+    }
+    user.type = static_cast<AccountType>(type);
+    return reader.next(field, size) && parseAmount(field, size, user.balance);
+}
+
+AccountRecord Serializer::deserializeAccount(const std::string& data) {
+    AccountRecord account;
+    User user;
+    if (deserializeUser(data.data(), data.size(), user)) {
+        account.username.swap(user.username);
+        account.password.swap(user.password);
+        account.type = user.type;
+        account.balance = user.balance;
+    }
+    return account;
+}
+
+const std::string Serializer::ACCOUNT_PASSWORD_FIELD = "password";
+const std::string Serializer::ACCOUNT_TYPE_FIELD = "type";
+const std::string Serializer::ACCOUNT_BALANCE_FIELD = "balance";
+
+std::map<std::string, std::string> Serializer::serializeAccountFields(const AccountRecord& account) {
+    std::map<std::string, std::string> fields;
+    fields[ACCOUNT_PASSWORD_FIELD] = account.password;
+    fields[ACCOUNT_TYPE_FIELD] = std::to_string(static_cast<int>(account.type));
+    fields[ACCOUNT_BALANCE_FIELD] = std::to_string(account.balance);
+    return fields;
+}
+
+bool Serializer::deserializeAccountFields(const std::string& username,
+    const std::map<std::string, std::string>& fields, AccountRecord& account) {
+    auto password = fields.find(ACCOUNT_PASSWORD_FIELD);
+    if (password == fields.end()) {
+        return false;
+    }
+    auto type = fields.find(ACCOUNT_TYPE_FIELD);
+    auto balance = fields.find(ACCOUNT_BALANCE_FIELD);
+
+    account.username = username;
+    account.password = password->second;
+    account.type = type == fields.end() ? PRIVATE_ACCOUNT : static_cast<AccountType>(std::atoi(type->second.c_str()));
+    account.balance = balance == fields.end() ? 0 : std::atoll(balance->second.c_str());
+    return true;
+}
+
 // 序列化和反序列化交易记录
-std::string Serializer::serializeTransaction(const TransactionRecord& tx) {
-    std::ostringstream ss;
-    ss << tx.id << "|"
-       << static_cast<int>(tx.type) << "|"
-       << tx.username << "|"
-       << tx.counterparty << "|"
-       << tx.amount << "|"
-       << tx.balance_after << "|"
-       << tx.description << "|"
-       << tx.timestamp;
-    
-    return ss.str();
+std::string Serializer::serializeTransaction(const TransactionRecord& tx, RecordFormat format) {
+    std::string out;
+    out.reserve(64 + tx.id.size() + tx.username.size() + tx.counterparty.size() + tx.description.size());
+    appendTransaction(tx, out, format);
+    return out;
+}
+
+void Serializer::appendTransaction(const TransactionRecord& tx, std::string& out, RecordFormat format) {
+    if (format == RECORD_FORMAT_BINARY) {
+        appendTransactionBinary(tx, out);
+        return;
+    }
+    out.append(tx.id);
+    out += FIELD_SEPARATOR;
+    appendInteger(out, static_cast<int>(tx.type));
+    out += FIELD_SEPARATOR;
+    out.append(tx.username);
+    out += FIELD_SEPARATOR;
+    out.append(tx.counterparty);
+    out += FIELD_SEPARATOR;
+    MoneyUtil::append(out, tx.amount);
+    out += FIELD_SEPARATOR;
+    MoneyUtil::append(out, tx.balance_after);
+    out += FIELD_SEPARATOR;
+    out.append(tx.description);
+    out += FIELD_SEPARATOR;
+    appendInteger(out, tx.timestamp);
 }
 
 TransactionRecord Serializer::deserializeTransaction(const std::string& data) {
     TransactionRecord tx;
-    std::istringstream ss(data);
-    std::string token;
-    
-    std::getline(ss, tx.id, '|');
-    
-    std::string typeStr;
-    std::getline(ss, typeStr, '|');
-    tx.type = static_cast<TransactionType>(std::stoi(typeStr));
-    
-    std::getline(ss, tx.username, '|');
-    std::getline(ss, tx.counterparty, '|');
-    
-    std::string amountStr;
-    std::getline(ss, amountStr, '|');
-    tx.amount = std::stod(amountStr);
-    
-    std::string balanceStr;
-    std::getline(ss, balanceStr, '|');
-    tx.balance_after = std::stod(balanceStr);
-    
-    std::getline(ss, tx.description, '|');
-    
-    std::string timestampStr;
-    std::getline(ss, timestampStr, '|');
-    tx.timestamp = std::stol(timestampStr);
-    
+    if (!deserializeTransaction(data.data(), data.size(), tx)) {
+        return TransactionRecord();
+    }
     return tx;
 }
 
+bool Serializer::deserializeTransaction(const char* data, size_t len, TransactionRecord& tx) {
+    const Schema* schema = findSchema(data, len);
+    return schema != nullptr && schema->decodeTransaction(data, len, tx);
+}
+
+bool Serializer::decodeTransactionText(const char* data, size_t len, TransactionRecord& tx) {
+    // 前6个分隔符划出固定字段，最后一个分隔符之后是时间戳，其余部分都属于描述（可含'|'）
+    const size_t FIXED_FIELDS = 6;
+    const size_t MAX_OFFSETS = 16;
+    size_t offsets[MAX_OFFSETS];
+    size_t count = separatorScannerEntry().scan(data, len, offsets, MAX_OFFSETS);
+    if (count < FIXED_FIELDS + 1) {
+        return false;
+    }
+    size_t last = offsets[count - 1];
+    if (count == MAX_OFFSETS) {
+        // 描述中分隔符过多，从尾部找最后一个
+        last = len;
+        while (data[last - 1] != FIELD_SEPARATOR) {
+            last--;
+        }
+        last--;
+    }
+
+    int type = 0;
+    long long timestamp = 0;
+    tx.id.assign(data, offsets[0]);
+    if (!parseInt(data + offsets[0] + 1, offsets[1] - offsets[0] - 1, type)) {
+        return false;
+    }
+    tx.type = static_cast<TransactionType>(type);
+    tx.username.assign(data + offsets[1] + 1, offsets[2] - offsets[1] - 1);
+    tx.counterparty.assign(data + offsets[2] + 1, offsets[3] - offsets[2] - 1);
+    if (!parseAmount(data + offsets[3] + 1, offsets[4] - offsets[3] - 1, tx.amount) ||
+        !parseAmount(data + offsets[4] + 1, offsets[5] - offsets[4] - 1, tx.balance_after)) {
+        return false;
+    }
+    tx.description.assign(data + offsets[5] + 1, last - offsets[5] - 1);
+    if (!parseInteger(data + last + 1, len - last - 1, timestamp)) {
+        return false;
+    }
+    tx.timestamp = static_cast<time_t>(timestamp);
+    return true;
+}
+
+size_t Serializer::deserializeTransactions(const std::vector<std::string>& records,
+    std::vector<TransactionRecord>& out, std::vector<size_t>& failed) {
+    // 直接解码到结果数组的元素中，复用其字符串容量
+    out.resize(records.size());
+    size_t count = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        const std::string& data = records[i];
+        if (deserializeTransaction(data.data(), data.size(), out[count])) {
+            count++;
+        }
+        else {
+            failed.push_back(i);
+        }
+    }
+    out.resize(count);
+    return count;
+}
+
 // 序列化和反序列化存款记录
-std::string Serializer::serializeDeposit(const Deposit& deposit) {
-    std::ostringstream ss;
-    ss << deposit.id << "|"
-       << deposit.username << "|"
-       << deposit.amount << "|"
-       << static_cast<int>(deposit.type) << "|"
-       << static_cast<int>(deposit.term) << "|"
-       << deposit.depositTime << "|"
-       << (deposit.isMatured ? "1" : "0");
-    
-    return ss.str();
+std::string Serializer::serializeDeposit(const Deposit& deposit, RecordFormat format) {
+    std::string out;
+    out.reserve(48 + deposit.id.size() + deposit.username.size());
+    appendDeposit(deposit, out, format);
+    return out;
+}
+
+void Serializer::appendDeposit(const Deposit& deposit, std::string& out, RecordFormat format) {
+    if (format == RECORD_FORMAT_BINARY) {
+        appendDepositBinary(deposit, out);
+        return;
+    }
+    out.append(deposit.id);
+    out += FIELD_SEPARATOR;
+    out.append(deposit.username);
+    out += FIELD_SEPARATOR;
+    MoneyUtil::append(out, deposit.amount);
+    out += FIELD_SEPARATOR;
+    appendInteger(out, static_cast<int>(deposit.type));
+    out += FIELD_SEPARATOR;
+    appendInteger(out, static_cast<int>(deposit.term));
+    out += FIELD_SEPARATOR;
+    appendInteger(out, deposit.depositTime);
+    out += FIELD_SEPARATOR;
+    out += deposit.isMatured ? '1' : '0';
 }
 
 Deposit Serializer::deserializeDeposit(const std::string& data) {
     Deposit deposit;
-    std::istringstream ss(data);
-    std::string token;
-    
-    std::getline(ss, deposit.id, '|');
-    std::getline(ss, deposit.username, '|');
-    
-    std::string amountStr;
-    std::getline(ss, amountStr, '|');
-    deposit.amount = std::stod(amountStr);
-    
-    std::string typeStr;
-    std::getline(ss, typeStr, '|');
-    deposit.type = static_cast<DepositType>(std::stoi(typeStr));
-    
-    std::string termStr;
-    std::getline(ss, termStr, '|');
-    deposit.term = static_cast<TimeDepositTerm>(std::stoi(termStr));
-    
-    std::string timeStr;
-    std::getline(ss, timeStr, '|');
-    deposit.depositTime = std::stol(timeStr);
-    
-    std::string maturedStr;
-    std::getline(ss, maturedStr, '|');
-    deposit.isMatured = (maturedStr == "1");
-    
+    if (!deserializeDeposit(data.data(), data.size(), deposit)) {
+        return Deposit();
+    }
     return deposit;
-}
\ No newline at end of file
+}
+
+bool Serializer::deserializeDeposit(const char* data, size_t len, Deposit& deposit) {
+    const Schema* schema = findSchema(data, len);
+    return schema != nullptr && schema->decodeDeposit(data, len, deposit);
+}
+
+bool Serializer::decodeDepositText(const char* data, size_t len, Deposit& deposit) {
+    FieldReader reader(data, len);
+    const char* field;
+    size_t size;
+    int type = 0;
+    int term = 0;
+    long long depositTime = 0;
+
+    if (!reader.next(field, size)) {
+        return false;
+    }
+    deposit.id.assign(field, size);
+    if (!reader.next(field, size)) {
+        return false;
+    }
+    deposit.username.assign(field, size);
+    if (!reader.next(field, size) || !parseAmount(field, size, deposit.amount)) {
+        return false;
+    }
+    if (!reader.next(field, size) || !parseInt(field, size, type)) {
+        return false;
+    }
+    deposit.type = static_cast<DepositType>(type);
+    if (!reader.next(field, size) || !parseInt(field, size, term)) {
+        return false;
+    }
+    deposit.term = static_cast<TimeDepositTerm>(term);
+    if (!reader.next(field, size) || !parseInteger(field, size, depositTime)) {
+        return false;
+    }
+    deposit.depositTime = static_cast<time_t>(depositTime);
+    if (!reader.next(field, size)) {
+        return false;
+    }
+    deposit.isMatured = size == 1 && field[0] == '1';
+    return true;
+}
+
+// 二进制记录：[版本][字段...]，字段顺序与文本格式相同
+void Serializer::appendUserBinary(const User& user, std::string& out) {
+    out += static_cast<char>(BINARY_VERSION);
+    appendBytes(out, user.username);
+    appendBytes(out, user.password);
+    appendVarint(out, static_cast<uint64_t>(user.type));
+    appendMoney(out, user.balance);
+}
+
+bool Serializer::decodeUserBinary(const char* data, size_t len, User& user) {
+    BinaryReader reader(data, len);
+    unsigned char version = 0;
+    int type = 0;
+    if (!reader.byte(version) || version != BINARY_VERSION ||
+        !reader.bytes(user.username) || !reader.bytes(user.password) ||
+        !reader.integer(type) || !reader.money(user.balance)) {
+        return false;
+    }
+    user.type = static_cast<AccountType>(type);
+    return reader.atEnd();
+}
+
+void Serializer::appendTransactionBinary(const TransactionRecord& tx, std::string& out) {
+    out += static_cast<char>(BINARY_VERSION);
+    appendBytes(out, tx.id);
+    appendVarint(out, static_cast<uint64_t>(tx.type));
+    appendBytes(out, tx.username);
+    appendBytes(out, tx.counterparty);
+    appendMoney(out, tx.amount);
+    appendMoney(out, tx.balance_after);
+    appendBytes(out, tx.description);
+    appendSigned(out, tx.timestamp);
+}
+
+bool Serializer::decodeTransactionBinary(const char* data, size_t len, TransactionRecord& tx) {
+    BinaryReader reader(data, len);
+    unsigned char version = 0;
+    int type = 0;
+    int64_t timestamp = 0;
+    if (!reader.byte(version) || version != BINARY_VERSION ||
+        !reader.bytes(tx.id) || !reader.integer(type) ||
+        !reader.bytes(tx.username) || !reader.bytes(tx.counterparty) ||
+        !reader.money(tx.amount) || !reader.money(tx.balance_after) ||
+        !reader.bytes(tx.description) || !reader.signedVarint(timestamp)) {
+        return false;
+    }
+    tx.type = static_cast<TransactionType>(type);
+    tx.timestamp = static_cast<time_t>(timestamp);
+    return reader.atEnd();
+}
+
+void Serializer::appendDepositBinary(const Deposit& deposit, std::string& out) {
+    out += static_cast<char>(BINARY_VERSION);
+    appendBytes(out, deposit.id);
+    appendBytes(out, deposit.username);
+    appendMoney(out, deposit.amount);
+    appendVarint(out, static_cast<uint64_t>(deposit.type));
+    appendVarint(out, static_cast<uint64_t>(deposit.term));
+    appendSigned(out, deposit.depositTime);
+    out += static_cast<char>(deposit.isMatured ? 1 : 0);
+}
+
+bool Serializer::decodeDepositBinary(const char* data, size_t len, Deposit& deposit) {
+    BinaryReader reader(data, len);
+    unsigned char version = 0;
+    int type = 0;
+    int term = 0;
+    int64_t depositTime = 0;
+    unsigned char matured = 0;
+    if (!reader.byte(version) || version != BINARY_VERSION ||
+        !reader.bytes(deposit.id) || !reader.bytes(deposit.username) ||
+        !reader.money(deposit.amount) || !reader.integer(type) || !reader.integer(term) ||
+        !reader.signedVarint(depositTime) || !reader.byte(matured)) {
+        return false;
+    }
+    deposit.type = static_cast<DepositType>(type);
+    deposit.term = static_cast<TimeDepositTerm>(term);
+    deposit.depositTime = static_cast<time_t>(depositTime);
+    deposit.isMatured = matured != 0;
+    return reader.atEnd();
+}
@@ -0,0 +1,340 @@
+// Snapshot.cpp - Writing and parallel loading of storage snapshots
+#include "Snapshot.h"
+#include "LogFormat.h"
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+
+const char SNAPSHOT_MAGIC[4] = { 'B', 'K', 'S', 'N' };
+const uint8_t SNAPSHOT_VERSION = 1;
+const size_t SNAPSHOT_HEADER_SIZE = 8;
+const size_t SNAPSHOT_TRAILER_SIZE = 12;   // CRC + 索引长度 + 魔数
+const size_t SHARD_INFO_SIZE = 28;
+
+enum EntryType {
+    ENTRY_STRING = 1,
+    ENTRY_HASH = 2,
+    ENTRY_LIST = 3
+};
+
+void putVarint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+bool getVarint(const char* data, size_t len, size_t& pos, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= len) {
+            return false;
+        }
+        unsigned char b = static_cast<unsigned char>(data[pos++]);
+        v |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void putBytes(std::string& out, const std::string& s) {
+    putVarint(out, s.size());
+    out.append(s);
+}
+
+bool getBytes(const char* data, size_t len, size_t& pos, std::string& s) {
+    uint64_t n = 0;
+    if (!getVarint(data, len, pos, n) || len - pos < n) {
+        return false;
+    }
+    s.assign(data + pos, static_cast<size_t>(n));
+    pos += static_cast<size_t>(n);
+    return true;
+}
+
+void putFixed(std::string& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+    }
+}
+
+uint64_t getFixed(const char* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; i++) {
+        v |= static_cast<uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    }
+    return v;
+}
+
+bool preadAll(int fd, char* buf, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t n = ::pread(fd, buf, len, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+// 解码一个分片数据区并写入目标存储
+bool decodeShard(const char* data, size_t len, MemoryStorage& target) {
+    size_t pos = 0;
+    std::string key;
+    std::string field;
+    std::string value;
+    while (pos < len) {
+        unsigned char type = static_cast<unsigned char>(data[pos++]);
+        if (!getBytes(data, len, pos, key)) {
+            return false;
+        }
+        if (type == ENTRY_STRING) {
+            if (!getBytes(data, len, pos, value)) {
+                return false;
+            }
+            target.set(key, value);
+        }
+        else if (type == ENTRY_HASH || type == ENTRY_LIST) {
+            uint64_t count = 0;
+            if (!getVarint(data, len, pos, count)) {
+                return false;
+            }
+            for (uint64_t i = 0; i < count; i++) {
+                if (type == ENTRY_HASH) {
+                    if (!getBytes(data, len, pos, field) || !getBytes(data, len, pos, value)) {
+                        return false;
+                    }
+                    target.hset(key, field, value);
+                }
+                else {
+                    if (!getBytes(data, len, pos, value)) {
+                        return false;
+                    }
+                    target.rpush(key, value);
+                }
+            }
+        }
+        else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+SnapshotWriter::SnapshotWriter(const std::string& path)
+    : path(path), tmpPath(path + ".tmp"), fd(-1), ok(false), offset(0) {
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    if (fd >= 0) {
+        // 未提交的快照直接丢弃
+        ::close(fd);
+        ::unlink(tmpPath.c_str());
+    }
+}
+
+bool SnapshotWriter::open() {
+    fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "无法创建快照文件 " << tmpPath << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    std::string header(SNAPSHOT_MAGIC, 4);
+    header.push_back(static_cast<char>(SNAPSHOT_VERSION));
+    header.append(3, '\0');
+    ok = true;
+    return writeBytes(header);
+}
+
+bool SnapshotWriter::writeBytes(const std::string& data) {
+    const char* p = data.data();
+    size_t len = data.size();
+    while (ok && len > 0) {
+        ssize_t n = ::write(fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            ok = false;
+            break;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return ok;
+}
+
+void SnapshotWriter::onString(const std::string& key, const std::string& value) {
+    buffer.push_back(static_cast<char>(ENTRY_STRING));
+    putBytes(buffer, key);
+    putBytes(buffer, value);
+}
+
+void SnapshotWriter::onHash(const std::string& key, const std::map<std::string, std::string>& fields) {
+    buffer.push_back(static_cast<char>(ENTRY_HASH));
+    putBytes(buffer, key);
+    putVarint(buffer, fields.size());
+    for (const auto& entry : fields) {
+        putBytes(buffer, entry.first);
+        putBytes(buffer, entry.second);
+    }
+}
+
+void SnapshotWriter::onList(const std::string& key, const std::deque<std::string>& items) {
+    buffer.push_back(static_cast<char>(ENTRY_LIST));
+    putBytes(buffer, key);
+    putVarint(buffer, items.size());
+    for (const auto& item : items) {
+        putBytes(buffer, item);
+    }
+}
+
+bool SnapshotWriter::writeShard(uint64_t cutLsn) {
+    ShardInfo info;
+    info.offset = offset;
+    info.size = buffer.size();
+    info.cutLsn = cutLsn;
+    info.crc = LogFormat::crc32(buffer.data(), buffer.size());
+    shards.push_back(info);
+
+    writeBytes(buffer);
+    buffer.clear();
+    buffer.shrink_to_fit();
+    return ok;
+}
+
+bool SnapshotWriter::commit(uint64_t baseSegment) {
+    std::string footer;
+    putFixed(footer, shards.size(), 4);
+    putFixed(footer, baseSegment, 8);
+    for (const auto& info : shards) {
+        putFixed(footer, info.offset, 8);
+        putFixed(footer, info.size, 8);
+        putFixed(footer, info.cutLsn, 8);
+        putFixed(footer, info.crc, 4);
+    }
+
+    std::string trailer;
+    putFixed(trailer, LogFormat::crc32(footer.data(), footer.size()), 4);
+    putFixed(trailer, footer.size(), 4);
+    trailer.append(SNAPSHOT_MAGIC, 4);
+
+    if (!writeBytes(footer) || !writeBytes(trailer) || ::fsync(fd) != 0) {
+        ok = false;
+    }
+    ::close(fd);
+    fd = -1;
+
+    if (!ok || ::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "快照写入失败 " << path << ": " << strerror(errno) << std::endl;
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotReader::load(const std::string& path, MemoryStorage& target,
+                          std::vector<uint64_t>& cutLsns, uint64_t& baseSegment, unsigned threads) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < SNAPSHOT_HEADER_SIZE + SNAPSHOT_TRAILER_SIZE) {
+        ::close(fd);
+        return false;
+    }
+    uint64_t fileSize = static_cast<uint64_t>(st.st_size);
+
+    // 校验文件头和尾部索引
+    char header[SNAPSHOT_HEADER_SIZE];
+    char trailer[SNAPSHOT_TRAILER_SIZE];
+    if (!preadAll(fd, header, sizeof(header), 0) ||
+        !preadAll(fd, trailer, sizeof(trailer), fileSize - SNAPSHOT_TRAILER_SIZE) ||
+        memcmp(header, SNAPSHOT_MAGIC, 4) != 0 || static_cast<uint8_t>(header[4]) != SNAPSHOT_VERSION ||
+        memcmp(trailer + 8, SNAPSHOT_MAGIC, 4) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    uint32_t footerCrc = static_cast<uint32_t>(getFixed(trailer, 4));
+    uint64_t footerSize = getFixed(trailer + 4, 4);
+    if (footerSize < 12 || footerSize > fileSize - SNAPSHOT_HEADER_SIZE - SNAPSHOT_TRAILER_SIZE) {
+        ::close(fd);
+        return false;
+    }
+    std::string footer(static_cast<size_t>(footerSize), '\0');
+    if (!preadAll(fd, &footer[0], footer.size(), fileSize - SNAPSHOT_TRAILER_SIZE - footerSize) ||
+        LogFormat::crc32(footer.data(), footer.size()) != footerCrc) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t shardCount = static_cast<size_t>(getFixed(footer.data(), 4));
+    if (footer.size() != 12 + shardCount * SHARD_INFO_SIZE) {
+        ::close(fd);
+        return false;
+    }
+    baseSegment = getFixed(footer.data() + 4, 8);
+
+    struct Section {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t crc;
+    };
+    std::vector<Section> sections(shardCount);
+    cutLsns.assign(shardCount, 0);
+    for (size_t i = 0; i < shardCount; i++) {
+        const char* p = footer.data() + 12 + i * SHARD_INFO_SIZE;
+        sections[i].offset = getFixed(p, 8);
+        sections[i].size = getFixed(p + 8, 8);
+        cutLsns[i] = getFixed(p + 16, 8);
+        sections[i].crc = static_cast<uint32_t>(getFixed(p + 24, 4));
+    }
+
+    // 各分片数据区互不依赖，并行读取和解码
+    if (threads < 1) {
+        threads = 1;
+    }
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.push_back(std::thread([&, t]() {
+            std::string data;
+            for (size_t i = t; i < shardCount && !failed; i += threads) {
+                data.resize(static_cast<size_t>(sections[i].size));
+                if ((!data.empty() && !preadAll(fd, &data[0], data.size(), sections[i].offset)) ||
+                    LogFormat::crc32(data.data(), data.size()) != sections[i].crc ||
+                    !decodeShard(data.data(), data.size(), target)) {
+                    failed = true;
+                }
+            }
+        }));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    ::close(fd);
+    return !failed;
+}
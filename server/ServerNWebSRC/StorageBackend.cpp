@@ -0,0 +1,35 @@
+// StorageBackend.cpp - Storage backend factory
+#include "StorageBackend.h"
+#include "RedisStorage.h"
+#include "MemoryStorage.h"
+#include "LogStorage.h"
+
+std::unique_ptr<StorageBackend> StorageBackend::create(const StorageConfig& config) {
+    switch (config.type) {
+    case STORAGE_MEMORY:
+        return std::unique_ptr<StorageBackend>(new MemoryStorage());
+    case STORAGE_LOCAL:
+        return std::unique_ptr<StorageBackend>(new LogStorage(config.dataDir, config.segmentSize,
+            config.commitIntervalUs, config.snapshotInterval));
+    case STORAGE_REDIS:
+    default:
+        return std::unique_ptr<StorageBackend>(new RedisStorage(
+            config.redisHost, config.redisPort, config.redisPassword, config.redisPoolSize));
+    }
+}
+
+bool StorageBackend::parseType(const std::string& name, StorageType& type) {
+    if (name == "redis") {
+        type = STORAGE_REDIS;
+        return true;
+    }
+    if (name == "memory") {
+        type = STORAGE_MEMORY;
+        return true;
+    }
+    if (name == "local") {
+        type = STORAGE_LOCAL;
+        return true;
+    }
+    return false;
+}
@@ -1,29 +1,19 @@
-// TransactionManager.cpp - Implementation of transaction functions with Redis
+// TransactionManager.cpp - Implementation of transaction functions
 #include "TransactionManager.h"
 #include "Serializer.h"
 #include <ctime>
-#include <iomanip>
-#include <sstream>
+#include <iostream>
+#include <algorithm>
 
-// Redis key prefixes
-const std::string TRANSACTION_COUNTER_KEY = "transaction:counter";
+// Storage key prefixes
 const std::string USER_TRANSACTIONS_KEY_PREFIX = "user:transactions:";
 
-TransactionManager::TransactionManager(AccountManager& am) 
-    : accountManager(am), redis("localhost", 6379) {
-    // 尝试从Redis获取当前交易计数器值
-    std::string counter_str = redis.get(getTransactionCounterKey());
-    if (!counter_str.empty()) {
-        transaction_counter = std::stoi(counter_str);
-    }
-}
+const size_t TransactionManager::DEFAULT_HISTORY_PAGE;
+const size_t TransactionManager::MAX_HISTORY_PAGE;
 
-bool TransactionManager::connect() {
-    return redis.connect();
-}
-
-std::string TransactionManager::getTransactionCounterKey() {
-    return TRANSACTION_COUNTER_KEY;
+TransactionManager::TransactionManager(AccountManager& am, StorageBackend& storage, unsigned nodeId,
+                                       RecordFormat recordFormat)
+    : accountManager(am), storage(storage), idGenerator(nodeId), recordFormat(recordFormat) {
 }
 
 std::string TransactionManager::getUserTransactionsKey(const std::string& username) {
@@ -31,35 +21,14 @@ std::string TransactionManager::getUserTransactionsKey(const std::string& userna
 }
 
 std::string TransactionManager::generateTransactionId() {
-    std::lock_guard<std::mutex> lock(transaction_mutex);
-    transaction_counter++;
-    
-    // 更新Redis中的计数器
-    redis.set(getTransactionCounterKey(), std::to_string(transaction_counter));
-    
-    // 生成带时间戳的交易ID：TX-年月日-计数器
-    std::time_t now = std::time(nullptr);
-    std::tm* now_tm = std::localtime(&now);
-    
-    std::ostringstream oss;
-    oss << "TX-"
-        << std::setw(4) << std::setfill('0') << (now_tm->tm_year + 1900)
-        << std::setw(2) << std::setfill('0') << (now_tm->tm_mon + 1)
-        << std::setw(2) << std::setfill('0') << now_tm->tm_mday
-        << "-" << std::setw(6) << std::setfill('0') << transaction_counter;
-    
-    return oss.str();
+    // 时间戳+节点ID+序列号，无锁且不访问存储：TX-<16位十六进制>
+    return idGenerator.nextString("TX-");
 }
 
-void TransactionManager::recordTransaction(const std::string& username, TransactionType type, 
-                                          double amount, double balance_after, 
-                                          const std::string& counterparty, 
-                                          const std::string& description) {
-    User* user = accountManager.getUser(username);
-    if (!user) {
-        return;
-    }
-    
+std::string TransactionManager::recordTransaction(const std::string& username, TransactionType type, 
+                                                 Money amount, Money balance_after, 
+                                                 const std::string& counterparty, 
+                                                 const std::string& description) {
     TransactionRecord record;
     record.id = generateTransactionId();
     record.type = type;
@@ -71,130 +40,274 @@ void TransactionManager::recordTransaction(const std::string& username, Transact
     record.timestamp = std::time(nullptr);
     
     // 序列化交易记录
-    std::string serialized = Serializer::serializeTransaction(record);
+    std::string serialized = Serializer::serializeTransaction(record, recordFormat);
     
-    // 存储到Redis
-    redis.rpush(getUserTransactionsKey(username), serialized);
-    
-    // 释放从getUser获取的内存
-    delete user;
+    // 写入存储
+    storage.rpush(getUserTransactionsKey(username), serialized);
+
+    return record.id;
 }
 
-bool TransactionManager::deposit(const std::string& username, double amount) {
+TransactionResult TransactionManager::deposit(const std::string& username, Money amount) {
+    TransactionResult result;
     if (amount <= 0) {
-        return false;
+        return result;
     }
 
-    User* user = accountManager.getUser(username);
-    if (!user) {
-        return false;
-    }
-
-    user->balance += amount;
-    
-    // 更新用户信息到Redis
-    bool updated = accountManager.updateUser(*user);
+    Money balance = 0;
+    bool updated = accountManager.adjustBalance(username, amount, balance);
     
     // 记录存款交易
     if (updated) {
-        recordTransaction(username, DEPOSIT, amount, user->balance, "", "存款");
+        result.transactionId = recordTransaction(username, DEPOSIT, amount, balance, "", "存款");
     }
+    result.balance = balance;
     
-    // 释放从getUser获取的内存
-    delete user;
-    
-    return updated;
+    // 等待本次修改持久化后再返回
+    result.success = updated && storage.sync();
+    return result;
 }
 
-bool TransactionManager::withdraw(const std::string& username, double amount) {
+TransactionResult TransactionManager::withdraw(const std::string& username, Money amount) {
+    TransactionResult result;
     if (amount <= 0) {
-        return false;
+        return result;
     }
 
-    User* user = accountManager.getUser(username);
-    if (!user || user->balance < amount) {
-        delete user;
-        return false;
-    }
-
-    user->balance -= amount;
-    
-    // 更新用户信息到Redis
-    bool updated = accountManager.updateUser(*user);
+    Money balance = 0;
+    bool updated = accountManager.adjustBalance(username, -amount, balance);
     
     // 记录取款交易
     if (updated) {
-        recordTransaction(username, WITHDRAWAL, amount, user->balance, "", "取款");
+        result.transactionId = recordTransaction(username, WITHDRAWAL, amount, balance, "", "取款");
     }
+    result.balance = balance;
     
-    // 释放从getUser获取的内存
-    delete user;
-    
-    return updated;
+    // 等待本次修改持久化后再返回
+    result.success = updated && storage.sync();
+    return result;
 }
 
-bool TransactionManager::transfer(const std::string& from_username, const std::string& to_username, double amount) {
-    if (amount <= 0) {
-        return false;
+TransactionResult TransactionManager::transfer(const std::string& from_username, const std::string& to_username, Money amount) {
+    TransactionResult result;
+    // 转给自己会在同一账户上先减后加，直接拒绝
+    if (amount <= 0 || from_username == to_username) {
+        return result;
     }
 
-    User* from_user = accountManager.getUser(from_username);
-    User* to_user = accountManager.getUser(to_username);
+    // 余额由分片持有或在存储端原子增减时，两个账户分两阶段各自调整；
+    // 只有未分片的账户表模式才在内存槽位上读-改-写（分片持有的副本不能绕过分片直接改写）
+    if (accountManager.getShards() || !accountManager.usesAccountTable()) {
+        return transferInPhases(from_username, to_username, amount);
+    }
 
-    if (!from_user || !to_user || from_user->balance < amount) {
-        delete from_user;
-        delete to_user;
-        return false;
+    // 按条带顺序同时锁定两个账户
+    LockStripes::Guard guard(accountManager.getAccountLocks(), from_username, to_username);
+    AccountRecord from_user;
+    AccountRecord to_user;
+    if (!accountManager.getAccount(from_username, from_user) ||
+        !accountManager.getAccount(to_username, to_user) ||
+        from_user.balance < amount) {
+        return result;
     }
 
-    from_user->balance -= amount;
-    to_user->balance += amount;
+    from_user.balance -= amount;
+    to_user.balance += amount;
     
-    // 更新两个用户的信息到Redis
-    bool from_updated = accountManager.updateUser(*from_user);
-    bool to_updated = accountManager.updateUser(*to_user);
+    // 更新两个用户的信息到存储
+    bool from_updated = accountManager.updateAccount(from_user);
+    bool to_updated = accountManager.updateAccount(to_user);
     
     if (from_updated && to_updated) {
         // 记录转出交易
-        recordTransaction(from_username, TRANSFER_OUT, amount, from_user->balance, 
-                         to_username, "转账给 " + to_username);
+        result.transactionId = recordTransaction(from_username, TRANSFER_OUT, amount, from_user.balance, 
+                                                 to_username, "转账给 " + to_username);
         
         // 记录转入交易
-        recordTransaction(to_username, TRANSFER_IN, amount, to_user->balance, 
+        recordTransaction(to_username, TRANSFER_IN, amount, to_user.balance, 
                          from_username, "收到来自 " + from_username + " 的转账");
     }
+    result.balance = from_user.balance;
     
-    // 释放从getUser获取的内存
-    delete from_user;
-    delete to_user;
-    
-    return from_updated && to_updated;
+    // 等待本次修改持久化后再返回
+    result.success = from_updated && to_updated && storage.sync();
+    return result;
 }
 
-double TransactionManager::getBalance(const std::string& username) {
-    User* user = accountManager.getUser(username);
-    if (!user) {
-        return -1.0;  // User does not exist
+TransactionResult TransactionManager::transferInPhases(const std::string& from_username, const std::string& to_username, Money amount) {
+    TransactionResult result;
+
+    // 账户不会被删除，收款方存在则第二阶段只会因写入失败而中止
+    Money to_balance = 0;
+    if (!accountManager.getBalance(to_username, to_balance)) {
+        return result;
     }
 
-    double balance = user->balance;
-    
-    // 释放从getUser获取的内存
-    delete user;
-    
+    // 第一阶段（准备）：转出方扣款，资金处于在途状态
+    Money from_balance = 0;
+    bool prepared = accountManager.adjustBalance(from_username, -amount, from_balance);
+    if (!prepared) {
+        return result;
+    }
+
+    // 第二阶段（提交）：收款方入账
+    bool committed = accountManager.adjustBalance(to_username, amount, to_balance);
+    if (!committed) {
+        // 中止：退回转出方
+        Money refunded_balance = 0;
+        bool refunded = accountManager.adjustBalance(from_username, amount, refunded_balance);
+        if (!refunded) {
+            std::cerr << "转账中止后退款失败: " << from_username << " " << MoneyUtil::format(amount) << std::endl;
+        }
+        return result;
+    }
+
+    result.transactionId = recordTransaction(from_username, TRANSFER_OUT, amount, from_balance,
+                                             to_username, "转账给 " + to_username);
+    recordTransaction(to_username, TRANSFER_IN, amount, to_balance,
+                      from_username, "收到来自 " + from_username + " 的转账");
+    result.balance = from_balance;
+
+    // 等待本次修改持久化后再返回
+    result.success = storage.sync();
+    return result;
+}
+
+Money TransactionManager::getBalance(const std::string& username) {
+    Money balance = 0;
+    if (!accountManager.getBalance(username, balance)) {
+        return -1;  // User does not exist
+    }
     return balance;
 }
 
 std::vector<TransactionRecord> TransactionManager::getTransactionHistory(const std::string& username) {
     std::vector<TransactionRecord> transactions;
     
-    // 从Redis获取用户的所有交易记录
-    std::vector<std::string> serialized_txs = redis.lrange(getUserTransactionsKey(username), 0, -1);
-    
-    for (const auto& serialized : serialized_txs) {
-        TransactionRecord tx = Serializer::deserializeTransaction(serialized);
-        transactions.push_back(tx);
-    }
+    // 从存储获取用户的所有交易记录
+    const std::string key = getUserTransactionsKey(username);
+    std::vector<std::string> serialized_txs = storage.lrange(key, 0, -1);
+    decodeRange(key, 0, serialized_txs, transactions);
     
     return transactions;
+}
+
+bool TransactionManager::getTransactionPage(const std::string& username, size_t limit, const std::string& cursor,
+                                            TransactionPage& page) {
+    const std::string key = getUserTransactionsKey(username);
+    page.transactions.clear();
+    page.nextCursor.clear();
+    page.total = storage.llen(key);
+
+    // 本页为下标[start, end)的记录。列表只在尾部追加，已有记录的下标不变，
+    // 所以游标在新交易写入后仍指向同一位置，也不必用负数下标（负数下标会随追加移动）
+    size_t end = page.total;
+    if (!cursor.empty() && (!decodeCursor(cursor, end) || end > page.total)) {
+        return false;
+    }
+    if (limit == 0 || limit > MAX_HISTORY_PAGE) {
+        limit = limit == 0 ? DEFAULT_HISTORY_PAGE : MAX_HISTORY_PAGE;
+    }
+    size_t start = end > limit ? end - limit : 0;
+    if (start == end) {
+        return true;
+    }
+
+    std::vector<std::string> serialized_txs = storage.lrange(key, static_cast<int>(start), static_cast<int>(end - 1));
+    decodeRange(key, start, serialized_txs, page.transactions);
+    std::reverse(page.transactions.begin(), page.transactions.end());
+    if (start > 0) {
+        page.nextCursor = encodeCursor(start);
+    }
+    return true;
+}
+
+void TransactionManager::decodeRange(const std::string& key, size_t first, const std::vector<std::string>& serialized,
+                                     std::vector<TransactionRecord>& transactions) {
+    // 批量解码，跳过无法解析的记录
+    std::vector<size_t> failed;
+    Serializer::deserializeTransactions(serialized, transactions, failed);
+    for (size_t index : failed) {
+        std::cerr << "无法解析交易记录: " << serialized[index] << std::endl;
+    }
+
+    // 旧版本记录按当前格式写回原位置（decoded为对应的解码结果下标）
+    size_t decoded = 0;
+    size_t nextFailed = 0;
+    for (size_t i = 0; i < serialized.size(); i++) {
+        if (nextFailed < failed.size() && failed[nextFailed] == i) {
+            nextFailed++;
+            continue;
+        }
+        if (Serializer::needsUpgrade(serialized[i].data(), serialized[i].size(), recordFormat)) {
+            rewriteTransaction(key, first + i, transactions[decoded]);
+        }
+        decoded++;
+    }
+}
+
+std::string TransactionManager::encodeCursor(size_t index) {
+    // 对客户端不透明：前缀+十六进制下标
+    static const char HEX[] = "0123456789abcdef";
+    std::string cursor = "c";
+    char digits[16];
+    size_t n = 0;
+    do {
+        digits[n++] = HEX[index & 0xF];
+        index >>= 4;
+    } while (index > 0);
+    while (n > 0) {
+        cursor += digits[--n];
+    }
+    return cursor;
+}
+
+bool TransactionManager::decodeCursor(const std::string& cursor, size_t& index) {
+    if (cursor.size() < 2 || cursor.size() > 17 || cursor[0] != 'c') {
+        return false;
+    }
+    size_t value = 0;
+    for (size_t i = 1; i < cursor.size(); i++) {
+        char c = cursor[i];
+        unsigned digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        }
+        else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        }
+        else {
+            return false;
+        }
+        value = (value << 4) | digit;
+    }
+    index = value;
+    return true;
+}
+
+size_t TransactionManager::upgradeTransactions(const std::string& username) {
+    const std::string key = getUserTransactionsKey(username);
+    std::vector<std::string> serialized_txs = storage.lrange(key, 0, -1);
+
+    size_t upgraded = 0;
+    TransactionRecord record;
+    for (size_t i = 0; i < serialized_txs.size(); i++) {
+        const std::string& serialized = serialized_txs[i];
+        if (Serializer::needsUpgrade(serialized.data(), serialized.size(), recordFormat) &&
+            Serializer::deserializeTransaction(serialized.data(), serialized.size(), record) &&
+            rewriteTransaction(key, i, record)) {
+            upgraded++;
+        }
+    }
+    return upgraded;
+}
+
+bool TransactionManager::rewriteTransaction(const std::string& key, size_t index, const TransactionRecord& record) {
+    // 交易列表只在尾部追加、记录写入后不再修改，同一下标始终是同一条记录，
+    // 并发的读取方即使重复改写也写入相同内容
+    if (!storage.lset(key, static_cast<int>(index), Serializer::serializeTransaction(record, recordFormat))) {
+        std::cerr << "交易记录升级失败: " << key << " #" << index << std::endl;
+        return false;
+    }
+    return true;
 }
\ No newline at end of file
@@ -0,0 +1,184 @@
+// WriteAheadLog.cpp - Group commit: writers append, one committer thread batches fdatasync calls
+#include "WriteAheadLog.h"
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+
+// 吞吐统计输出间隔
+const std::chrono::seconds REPORT_INTERVAL(10);
+
+} // namespace
+
+WriteAheadLog::WriteAheadLog(unsigned commitIntervalUs)
+    : fd(-1), appendedLsn(0), durableLsn(0), syncing(false), failed(false), stopping(false),
+      commitIntervalUs(commitIntervalUs), records(0), commits(0), fsyncs(0) {
+    lastReport.records = 0;
+    lastReport.commits = 0;
+    lastReport.fsyncs = 0;
+    lastReportTime = std::chrono::steady_clock::now();
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    stop();
+}
+
+void WriteAheadLog::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!committer.joinable()) {
+        stopping = false;
+        committer = std::thread(&WriteAheadLog::commitLoop, this);
+    }
+}
+
+void WriteAheadLog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    appendedCv.notify_all();
+    if (committer.joinable()) {
+        committer.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd >= 0) {
+        ::fdatasync(fd);
+        ::close(fd);
+        fd = -1;
+        durableLsn = appendedLsn;
+        durableCv.notify_all();
+    }
+}
+
+bool WriteAheadLog::switchFile(int newFd) {
+    std::unique_lock<std::mutex> lock(mutex);
+    durableCv.wait(lock, [this] { return !syncing; });
+
+    bool ok = true;
+    if (fd >= 0) {
+        ok = ::fdatasync(fd) == 0;
+        ::close(fd);
+        fsyncs++;
+        if (ok) {
+            durableLsn = appendedLsn;
+        }
+        else {
+            failed = true;
+        }
+        durableCv.notify_all();
+    }
+    fd = newFd;
+    return ok;
+}
+
+uint64_t WriteAheadLog::append(const std::string& frame) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (fd < 0) {
+        return 0;
+    }
+
+    const char* data = frame.data();
+    size_t len = frame.size();
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "WAL写入失败: " << strerror(errno) << std::endl;
+            return 0;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+
+    uint64_t lsn = ++appendedLsn;
+    records++;
+    lock.unlock();
+
+    appendedCv.notify_one();
+    return lsn;
+}
+
+bool WriteAheadLog::sync() {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = appendedLsn;
+    durableCv.wait(lock, [this, target] { return durableLsn >= target || failed; });
+    commits++;
+    return !failed;
+}
+
+void WriteAheadLog::commitLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        appendedCv.wait_for(lock, std::chrono::seconds(1), [this] {
+            return stopping || appendedLsn > durableLsn;
+        });
+        if (appendedLsn == durableLsn) {
+            if (stopping) {
+                break;
+            }
+            report(false);
+            continue;
+        }
+
+        // 等待一个提交间隔，让更多写入加入同一批次
+        if (!stopping && commitIntervalUs > 0) {
+            lock.unlock();
+            std::this_thread::sleep_for(std::chrono::microseconds(commitIntervalUs));
+            lock.lock();
+        }
+
+        uint64_t target = appendedLsn;
+        int syncFd = fd;
+        syncing = true;
+        lock.unlock();
+
+        bool ok = syncFd < 0 || ::fdatasync(syncFd) == 0;
+
+        lock.lock();
+        syncing = false;
+        fsyncs++;
+        if (!ok) {
+            std::cerr << "WAL刷盘失败: " << strerror(errno) << std::endl;
+            failed = true;
+        }
+        else if (target > durableLsn) {
+            durableLsn = target;
+        }
+        durableCv.notify_all();
+        report(false);
+    }
+    report(true);
+}
+
+// 调用时持有mutex
+void WriteAheadLog::report(bool force) {
+    auto now = std::chrono::steady_clock::now();
+    if (!force && now - lastReportTime < REPORT_INTERVAL) {
+        return;
+    }
+
+    Stats current = getStats();
+    double seconds = std::chrono::duration<double>(now - lastReportTime).count();
+    if (current.commits != lastReport.commits && seconds > 0) {
+        uint64_t commitDelta = current.commits - lastReport.commits;
+        uint64_t fsyncDelta = current.fsyncs - lastReport.fsyncs;
+        std::cout << "WAL: " << static_cast<uint64_t>(commitDelta / seconds) << " commits/s, "
+                  << static_cast<uint64_t>(fsyncDelta / seconds) << " fsyncs/s, "
+                  << (fsyncDelta > 0 ? commitDelta / fsyncDelta : commitDelta) << " commits/fsync" << std::endl;
+    }
+    lastReport = current;
+    lastReportTime = now;
+}
+
+WriteAheadLog::Stats WriteAheadLog::getStats() const {
+    Stats stats;
+    stats.records = records.load();
+    stats.commits = commits.load();
+    stats.fsyncs = fsyncs.load();
+    return stats;
+}
@@ -3,12 +3,26 @@
 #include <csignal>
 #include <cstring>
 #include "BankingApp.h"
+#include "Serializer.h"
 
 // Constants
 const int DEFAULT_PORT = 8080;
 const std::string DEFAULT_REDIS_HOST = "localhost";
 const int DEFAULT_REDIS_PORT = 6379;
 const std::string DEFAULT_REDIS_PASSWORD = "";
+const int DEFAULT_REDIS_POOL_SIZE = 4;
+const std::string DEFAULT_STORAGE = "redis";
+const std::string DEFAULT_DATA_DIR = "data";
+const int DEFAULT_SEGMENT_SIZE_MB = 64;
+const int DEFAULT_COMMIT_INTERVAL_US = 200;
+const int DEFAULT_SNAPSHOT_INTERVAL = 300;
+const unsigned DEFAULT_ACCOUNT_TABLE_CAPACITY = 1000000;
+const unsigned DEFAULT_ACCOUNT_CACHE_SIZE = 10000;
+const unsigned DEFAULT_USERNAME_FILTER_CAPACITY = 1000000;
+const unsigned DEFAULT_ACCOUNT_SHARDS = 0;
+const unsigned DEFAULT_NODE_ID = 0;
+const std::string DEFAULT_RECORD_FORMAT = "text";
+const unsigned DEFAULT_CONVERT_RECORDS_PER_SEC = 0;
 
 // Global application pointer for signal handling
 BankingApp* globalApp = nullptr;
@@ -32,14 +46,49 @@ void printHelp(const char* programName) {
     std::cout << "  --redis-host <host>         Redis server host (default: " << DEFAULT_REDIS_HOST << ")\n";
     std::cout << "  --redis-port <port>         Redis server port (default: " << DEFAULT_REDIS_PORT << ")\n";
     std::cout << "  --redis-password <password> Redis server password (default: none)\n";
+    std::cout << "  --redis-pool-size <n>       Number of Redis connections (default: " << DEFAULT_REDIS_POOL_SIZE << ")\n";
+    std::cout << "  --redis-tracking            Keep the account cache coherent via RESP3 invalidations\n";
+    std::cout << "  --embedded-redis            Start an in-process fake Redis on --redis-port\n";
+    std::cout << "  --redis-latency-us <n>      Reply latency injected by the embedded Redis (default: 0)\n";
+    std::cout << "  --storage <memory|redis|local> Storage backend (default: " << DEFAULT_STORAGE << ")\n";
+    std::cout << "  --data-dir <dir>            Data directory for local storage (default: " << DEFAULT_DATA_DIR << ")\n";
+    std::cout << "  --segment-size-mb <n>       Local storage log segment size (default: " << DEFAULT_SEGMENT_SIZE_MB << ")\n";
+    std::cout << "  --commit-interval-us <n>    WAL group commit interval (default: " << DEFAULT_COMMIT_INTERVAL_US << ")\n";
+    std::cout << "  --snapshot-interval <sec>   Local storage snapshot interval (default: " << DEFAULT_SNAPSHOT_INTERVAL << ")\n";
+    std::cout << "  --account-cache-size <n>    In-process account cache entries, 0 disables (default: " << DEFAULT_ACCOUNT_CACHE_SIZE
+              << ", or 0 for Redis storage without --redis-tracking)\n";
+    std::cout << "  --username-filter-capacity <n> Username Bloom filter size, 0 disables (default: " << DEFAULT_USERNAME_FILTER_CAPACITY
+              << ", or 0 for Redis storage without --redis-tracking)\n";
+    std::cout << "  --account-table <file>      Memory-mapped account table file, single instance only (default: disabled)\n";
+    std::cout << "  --account-table-capacity <n> Account table slots (default: " << DEFAULT_ACCOUNT_TABLE_CAPACITY << ")\n";
+    std::cout << "  --node-id <0-1023>          Node ID embedded in transaction IDs, unique per server instance (default: " << DEFAULT_NODE_ID << ")\n";
+    std::cout << "  --account-shards <n>        Run account mutations on n shard threads, 0 uses lock striping; single instance only (default: " << DEFAULT_ACCOUNT_SHARDS << ")\n";
+    std::cout << "  --record-format <text|binary> Encoding of new transaction/deposit records, both are readable (default: " << DEFAULT_RECORD_FORMAT << ")\n";
+    std::cout << "  --convert-records-per-sec <n> Rewrite older records to the record format in the background, 0 upgrades on read only (default: " << DEFAULT_CONVERT_RECORDS_PER_SEC << ")\n";
 }
 
 int main(int argc, char* argv[]) {
     // Default settings
     int port = DEFAULT_PORT;
-    std::string redisHost = DEFAULT_REDIS_HOST;
-    int redisPort = DEFAULT_REDIS_PORT;
-    std::string redisPassword = DEFAULT_REDIS_PASSWORD;
+    StorageConfig storageConfig;
+    storageConfig.type = STORAGE_REDIS;
+    storageConfig.redisHost = DEFAULT_REDIS_HOST;
+    storageConfig.redisPort = DEFAULT_REDIS_PORT;
+    storageConfig.redisPassword = DEFAULT_REDIS_PASSWORD;
+    storageConfig.redisPoolSize = DEFAULT_REDIS_POOL_SIZE;
+    storageConfig.dataDir = DEFAULT_DATA_DIR;
+    storageConfig.segmentSize = DEFAULT_SEGMENT_SIZE_MB * 1024ULL * 1024ULL;
+    storageConfig.commitIntervalUs = DEFAULT_COMMIT_INTERVAL_US;
+    storageConfig.snapshotInterval = DEFAULT_SNAPSHOT_INTERVAL;
+    storageConfig.accountTableCapacity = DEFAULT_ACCOUNT_TABLE_CAPACITY;
+    storageConfig.accountCacheSize = DEFAULT_ACCOUNT_CACHE_SIZE;
+    storageConfig.usernameFilterCapacity = DEFAULT_USERNAME_FILTER_CAPACITY;
+    storageConfig.accountShards = DEFAULT_ACCOUNT_SHARDS;
+    storageConfig.nodeId = DEFAULT_NODE_ID;
+    Serializer::parseRecordFormat(DEFAULT_RECORD_FORMAT, storageConfig.recordFormat);
+    storageConfig.convertRecordsPerSec = DEFAULT_CONVERT_RECORDS_PER_SEC;
+    bool accountCacheSizeSet = false;
+    bool usernameFilterCapacitySet = false;
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -56,7 +105,7 @@ int main(int argc, char* argv[]) {
             }
         } else if (strcmp(argv[i], "--redis-host") == 0) {
             if (i + 1 < argc) {
-                redisHost = argv[i + 1];
+                storageConfig.redisHost = argv[i + 1];
                 i++;
             } else {
                 std::cerr << "Error: Redis host not provided\n";
@@ -64,7 +113,7 @@ int main(int argc, char* argv[]) {
             }
         } else if (strcmp(argv[i], "--redis-port") == 0) {
             if (i + 1 < argc) {
-                redisPort = std::stoi(argv[i + 1]);
+                storageConfig.redisPort = std::stoi(argv[i + 1]);
                 i++;
             } else {
                 std::cerr << "Error: Redis port not provided\n";
@@ -72,12 +121,152 @@ int main(int argc, char* argv[]) {
             }
         } else if (strcmp(argv[i], "--redis-password") == 0) {
             if (i + 1 < argc) {
-                redisPassword = argv[i + 1];
+                storageConfig.redisPassword = argv[i + 1];
                 i++;
             } else {
                 std::cerr << "Error: Redis password not provided\n";
                 return 1;
             }
+        } else if (strcmp(argv[i], "--redis-pool-size") == 0) {
+            if (i + 1 < argc) {
+                storageConfig.redisPoolSize = std::stoi(argv[i + 1]);
+                i++;
+            } else {
+                std::cerr << "Error: Redis pool size not provided\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--redis-tracking") == 0) {
+            storageConfig.redisTracking = true;
+        } else if (strcmp(argv[i], "--embedded-redis") == 0) {
+            storageConfig.embeddedRedis = true;
+        } else if (strcmp(argv[i], "--redis-latency-us") == 0) {
+            if (i + 1 < argc) {
+                storageConfig.embeddedRedisLatencyUs = std::stoul(argv[i + 1]);
+                i++;
+            } else {
+                std::cerr << "Error: Redis latency not provided\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--storage") == 0 || strncmp(argv[i], "--storage=", 10) == 0) {
+            std::string storageName;
+            if (argv[i][9] == '=') {
+                storageName = argv[i] + 10;
+            } else if (i + 1 < argc) {
+                storageName = argv[i + 1];
+                i++;
+            } else {
+                std::cerr << "Error: Storage type not provided\n";
+                return 1;
+            }
+            if (!StorageBackend::parseType(storageName, storageConfig.type)) {
+                std::cerr << "Error: Unknown storage type '" << storageName << "'\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--data-dir") == 0) {
+            if (i + 1 < argc) {
+                storageConfig.dataDir = argv[i + 1];
+                i++;
+            } else {
+                std::cerr << "Error: Data directory not provided\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--segment-size-mb") == 0) {
+            if (i + 1 < argc) {
+                storageConfig.segmentSize = std::stoull(argv[i + 1]) * 1024ULL * 1024ULL;
+                i++;
+            } else {
+                std::cerr << "Error: Segment size not provided\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--commit-interval-us") == 0) {
+            if (i + 1 < argc) {
+                storageConfig.commitIntervalUs = std::stoul(argv[i + 1]);
+                i++;
+            } else {
+                std::cerr << "Error: Commit interval not provided\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--snapshot-interval") == 0) {
+            if (i + 1 < argc) {
+                storageConfig.snapshotInterval = std::stoul(argv[i + 1]);
+                i++;
+            } else {
+                std::cerr << "Error: Snapshot interval not provided\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--account-cache-size") == 0) {
+            if (i + 1 < argc) {
+                storageConfig.accountCacheSize = std::stoul(argv[i + 1]);
+                accountCacheSizeSet = true;
+                i++;
+            } else {
+                std::cerr << "Error: Account cache size not provided\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--username-filter-capacity") == 0) {
+            if (i + 1 < argc) {
+                storageConfig.usernameFilterCapacity = std::stoul(argv[i + 1]);
+                usernameFilterCapacitySet = true;
+                i++;
+            } else {
+                std::cerr << "Error: Username filter capacity not provided\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--node-id") == 0) {
+            if (i + 1 < argc) {
+                storageConfig.nodeId = std::stoul(argv[i + 1]);
+                if (storageConfig.nodeId > IdGenerator::MAX_NODE_ID) {
+                    std::cerr << "Error: Node ID must be between 0 and " << IdGenerator::MAX_NODE_ID << "\n";
+                    return 1;
+                }
+                i++;
+            } else {
+                std::cerr << "Error: Node ID not provided\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--account-shards") == 0) {
+            if (i + 1 < argc) {
+                storageConfig.accountShards = std::stoul(argv[i + 1]);
+                i++;
+            } else {
+                std::cerr << "Error: Account shard count not provided\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--record-format") == 0) {
+            if (i + 1 < argc) {
+                if (!Serializer::parseRecordFormat(argv[i + 1], storageConfig.recordFormat)) {
+                    std::cerr << "Error: Unknown record format '" << argv[i + 1] << "'\n";
+                    return 1;
+                }
+                i++;
+            } else {
+                std::cerr << "Error: Record format not provided\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--convert-records-per-sec") == 0) {
+            if (i + 1 < argc) {
+                storageConfig.convertRecordsPerSec = std::stoul(argv[i + 1]);
+                i++;
+            } else {
+                std::cerr << "Error: Conversion rate not provided\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--account-table") == 0) {
+            if (i + 1 < argc) {
+                storageConfig.accountTablePath = argv[i + 1];
+                i++;
+            } else {
+                std::cerr << "Error: Account table file not provided\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--account-table-capacity") == 0) {
+            if (i + 1 < argc) {
+                storageConfig.accountTableCapacity = std::stoul(argv[i + 1]);
+                i++;
+            } else {
+                std::cerr << "Error: Account table capacity not provided\n";
+                return 1;
+            }
         } else {
             std::cerr << "Error: Unknown option '" << argv[i] << "'\n";
             printHelp(argv[0]);
@@ -85,19 +274,60 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // 共享Redis上没有失效通知时，其他实例的修改不会反映到本地缓存，默认不启用缓存
+    if (storageConfig.type == STORAGE_REDIS && !storageConfig.redisTracking && storageConfig.accountCacheSize > 0) {
+        if (!accountCacheSizeSet) {
+            storageConfig.accountCacheSize = 0;
+        } else {
+            std::cout << "Warning: account cache without --redis-tracking is only safe for a single server instance\n";
+        }
+    }
+    // 同理，其他实例注册的用户不会进入本地过滤器，会被误判为不存在
+    if (storageConfig.type == STORAGE_REDIS && !storageConfig.redisTracking && storageConfig.usernameFilterCapacity > 0) {
+        if (!usernameFilterCapacitySet) {
+            storageConfig.usernameFilterCapacity = 0;
+        } else {
+            std::cout << "Warning: username filter without --redis-tracking is only safe for a single server instance\n";
+        }
+    }
+
+    // 分片持有的账户副本不会因其他实例的写入失效，--redis-tracking意味着多实例共享存储
+    if (storageConfig.accountShards > 0 && storageConfig.type == STORAGE_REDIS && storageConfig.redisTracking) {
+        std::cerr << "Error: --account-shards requires a single server instance and cannot be combined with --redis-tracking\n";
+        return 1;
+    }
+
+    // 账户表槽位是余额的权威副本并整体写回，同样看不到其他实例的修改
+    if (!storageConfig.accountTablePath.empty() && storageConfig.type == STORAGE_REDIS && storageConfig.redisTracking) {
+        std::cerr << "Error: --account-table requires a single server instance and cannot be combined with --redis-tracking\n";
+        return 1;
+    }
+
     // Setup signal handlers for graceful shutdown
     std::signal(SIGINT, signalHandler);
     std::signal(SIGTERM, signalHandler);
 
     try {
         // Create and run the banking application
-        BankingApp app(port, redisHost, redisPort, redisPassword);
+        BankingApp app(port, storageConfig);
         globalApp = &app;
         
         std::cout << "Starting banking system API server...\n";
         std::cout << "API port: " << port << "\n";
-        std::cout << "Redis host: " << redisHost << "\n";
-        std::cout << "Redis port: " << redisPort << "\n";
+        if (storageConfig.type == STORAGE_REDIS) {
+            std::cout << "Redis host: " << storageConfig.redisHost << "\n";
+            std::cout << "Redis port: " << storageConfig.redisPort << "\n";
+            if (storageConfig.embeddedRedis) {
+                std::cout << "Redis: embedded fake\n";
+            }
+        } else if (storageConfig.type == STORAGE_LOCAL) {
+            std::cout << "Storage: local (" << storageConfig.dataDir << ")\n";
+        } else {
+            std::cout << "Storage: in-memory\n";
+        }
+        if (!storageConfig.accountTablePath.empty()) {
+            std::cout << "Account table: " << storageConfig.accountTablePath << "\n";
+        }
         
         app.run();
         
@@ -0,0 +1,103 @@
+// AccountLookupBench.cpp - Heap allocations and latency of AccountManager balance lookups
+#include "AccountManager.h"
+#include "MemoryStorage.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstdio>
+
+namespace {
+
+std::atomic<uint64_t> allocations(0);
+
+std::string accountName(uint32_t i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "user%08u", i);
+    return buf;
+}
+
+// 运行lookup若干次，报告每次调用的堆分配次数和耗时
+template <typename Lookup>
+bool measure(const char* label, const std::vector<std::string>& names, uint64_t ops, Lookup lookup) {
+    Money sum = 0;
+    uint64_t before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < ops; i++) {
+        Money balance = 0;
+        if (!lookup(names[i % names.size()], balance)) {
+            std::cerr << "lookup failed" << std::endl;
+            return false;
+        }
+        sum += balance;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t allocated = allocations.load() - before;
+
+    std::cout << label << ": " << static_cast<double>(allocated) / ops << " allocs/op, "
+              << static_cast<uint64_t>(seconds * 1e9 / ops) << " ns/op (checksum " << sum << ")" << std::endl;
+    return true;
+}
+
+} // namespace
+
+// 统计全局operator new调用次数
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+// 用法: account_lookup_bench [账户数] [查询次数]
+int main(int argc, char* argv[]) {
+    uint32_t accounts = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 10000;
+    uint64_t ops = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+
+    MemoryStorage storage;
+    // 分片间分布不均，留出余量保证全部账户常驻缓存
+    AccountManager cached(storage, accounts * 2);
+    AccountManager uncached(storage, 0);
+
+    std::vector<std::string> names;
+    names.reserve(accounts);
+    for (uint32_t i = 0; i < accounts; i++) {
+        names.push_back(accountName(i));
+        if (!cached.registerUser(names.back(), "password", PRIVATE_ACCOUNT)) {
+            std::cerr << "register failed at " << i << std::endl;
+            return 1;
+        }
+    }
+
+    // 注册时已写入缓存，以下查询全部命中
+    bool ok = measure("getBalance (cache hit)", names, ops,
+        [&cached](const std::string& name, Money& balance) {
+            return cached.getBalance(name, balance);
+        });
+
+    AccountRecord account;
+    ok = ok && measure("getAccount (cache hit, reused record)", names, ops,
+        [&cached, &account](const std::string& name, Money& balance) {
+            if (!cached.getAccount(name, account)) {
+                return false;
+            }
+            balance = account.balance;
+            return true;
+        });
+
+    ok = ok && measure("getBalance (no cache)", names, ops,
+        [&uncached](const std::string& name, Money& balance) {
+            return uncached.getBalance(name, balance);
+        });
+
+    return ok ? 0 : 1;
+}
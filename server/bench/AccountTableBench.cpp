@@ -0,0 +1,85 @@
+// AccountTableBench.cpp - Random-access balance reads on a memory-mapped account table
+#include "AccountTable.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+
+namespace {
+
+std::string accountName(uint32_t i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "user%08u", i);
+    return buf;
+}
+
+void report(const char* label, uint64_t ops, double seconds) {
+    std::cout << label << ": " << static_cast<uint64_t>(seconds * 1e9 / ops) << " ns/op, "
+              << static_cast<uint64_t>(ops / seconds) << " ops/sec" << std::endl;
+}
+
+} // namespace
+
+// 用法: account_table_bench [账户数] [读取次数] [表文件]
+int main(int argc, char* argv[]) {
+    uint32_t accounts = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 10000000;
+    uint64_t reads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000000;
+    std::string path = argc > 3 ? argv[3] : "/tmp/account_table_bench.dat";
+
+    ::unlink(path.c_str());
+    AccountTable table(path, accounts);
+    if (!table.open()) {
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < accounts; i++) {
+        uint32_t id = 0;
+        if (!table.insert(accountName(i), "password", 0, static_cast<Money>(i), id)) {
+            std::cerr << "insert failed at " << i << std::endl;
+            return 1;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report("insert", accounts, seconds);
+
+    // 预先生成随机访问序列，不计入计时
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> pick(0, accounts - 1);
+    const size_t SAMPLE = 1 << 20;
+    std::vector<uint32_t> ids(SAMPLE);
+    std::vector<std::string> names(SAMPLE);
+    for (size_t i = 0; i < SAMPLE; i++) {
+        ids[i] = pick(rng);
+        names[i] = accountName(ids[i]);
+    }
+
+    Money sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < reads; i++) {
+        sum += table.readBalance(ids[i & (SAMPLE - 1)]);
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report("read balance by id", reads, seconds);
+
+    start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < reads; i++) {
+        uint32_t id = table.find(names[i & (SAMPLE - 1)]);
+        if (id == AccountTable::INVALID_ID) {
+            std::cerr << "lookup failed" << std::endl;
+            return 1;
+        }
+        sum += table.readBalance(id);
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report("read balance by name", reads, seconds);
+
+    std::cout << "checksum " << sum << std::endl;
+    table.close();
+    ::unlink(path.c_str());
+    return 0;
+}
@@ -0,0 +1,130 @@
+// JsonWriterBench.cpp - Bytes/sec of rendering a transaction history response, JsonWriter against the former concatenation
+#include "JsonWriter.h"
+#include "Common.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+
+namespace {
+
+// 改写前/api/transaction-history的拼接方式（不转义）
+std::string legacyRender(const std::vector<TransactionRecord>& transactions) {
+    std::string transactions_json = "[";
+    for (size_t i = 0; i < transactions.size(); i++) {
+        const auto& tx = transactions[i];
+
+        transactions_json += "{";
+        transactions_json += "\"id\":\"" + tx.id + "\",";
+        transactions_json += "\"type\":" + std::to_string(tx.type) + ",";
+        transactions_json += "\"amount\":" + MoneyUtil::format(tx.amount) + ",";
+        transactions_json += "\"balance_after\":" + MoneyUtil::format(tx.balance_after) + ",";
+        if (!tx.counterparty.empty()) {
+            transactions_json += "\"counterparty\":\"" + tx.counterparty + "\",";
+        } else {
+            transactions_json += "\"counterparty\":\"\",";
+        }
+        if (!tx.description.empty()) {
+            transactions_json += "\"description\":\"" + tx.description + "\",";
+        } else {
+            transactions_json += "\"description\":\"\",";
+        }
+        transactions_json += "\"timestamp\":" + std::to_string(tx.timestamp);
+        transactions_json += "}";
+
+        if (i < transactions.size() - 1) {
+            transactions_json += ",";
+        }
+    }
+    transactions_json += "]";
+
+    return "{\"status\":\"success\",\"transactions\":" + transactions_json + "}";
+}
+
+std::string writerRender(const std::vector<TransactionRecord>& transactions) {
+    JsonWriter json(64 + transactions.size() * 160);
+    json.beginObject().key("status").string("success").key("transactions").beginArray();
+    for (const auto& tx : transactions) {
+        json.beginObject()
+            .key("id").string(tx.id)
+            .key("type").integer(tx.type)
+            .key("amount").money(tx.amount)
+            .key("balance_after").money(tx.balance_after)
+            .key("counterparty").string(tx.counterparty)
+            .key("description").string(tx.description)
+            .key("timestamp").integer(tx.timestamp)
+            .endObject();
+    }
+    json.endArray().endObject();
+    return json.release();
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* label, uint64_t bytes, uint64_t responses, double seconds) {
+    std::cout << label << ": " << static_cast<uint64_t>(bytes / seconds / (1024 * 1024)) << " MB/sec, "
+              << static_cast<uint64_t>(seconds * 1e6 / responses) << " us/response" << std::endl;
+}
+
+} // namespace
+
+// 用法: json_writer_bench [每个响应的交易数] [响应数]
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::strtoul(argv[1], nullptr, 10)) : 1000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 1000;
+    if (count == 0 || rounds <= 0) {
+        return 1;
+    }
+
+    std::vector<TransactionRecord> transactions(count);
+    for (size_t i = 0; i < count; i++) {
+        char id[32];
+        snprintf(id, sizeof(id), "TX-%016zX", i);
+        TransactionRecord& tx = transactions[i];
+        tx.id = id;
+        tx.type = static_cast<TransactionType>(1 + i % 4);
+        tx.username = "user" + std::to_string(i % 1000);
+        tx.counterparty = i % 4 >= 2 ? "user" + std::to_string((i + 7) % 1000) : "";
+        tx.amount = static_cast<Money>(i * 137 % 1000000);
+        tx.balance_after = static_cast<Money>(i * 7919 % 100000000);
+        tx.description = i % 4 >= 2 ? "转账给 " + tx.counterparty : "存款";
+        tx.timestamp = 1700000000 + static_cast<time_t>(i);
+    }
+
+    uint64_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        bytes += legacyRender(transactions).size();
+    }
+    report("concatenation", bytes, rounds, secondsSince(start));
+
+    bytes = 0;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        bytes += writerRender(transactions).size();
+    }
+    report("JsonWriter", bytes, rounds, secondsSince(start));
+
+    // 没有需要转义的字符时两者输出相同
+    if (legacyRender(transactions) != writerRender(transactions)) {
+        std::cerr << "output mismatch" << std::endl;
+        return 1;
+    }
+
+    // 用户输入的描述较长且含引号/换行时的转义开销
+    for (size_t i = 0; i < count; i++) {
+        transactions[i].description = "备注: \"季度结算\" 第" + std::to_string(i) + "笔，含换行\n及反斜杠\\，后附一段较长的说明文字用于测量整块跳过的速度";
+    }
+    bytes = 0;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        bytes += writerRender(transactions).size();
+    }
+    report("JsonWriter (escaped descriptions)", bytes, rounds, secondsSince(start));
+
+    return 0;
+}
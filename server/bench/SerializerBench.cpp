@@ -0,0 +1,331 @@
+// SerializerBench.cpp - Records/sec and size of the Serializer formats against the former stringstream version,
+// and bulk history decoding with each separator scanner
+#include "Serializer.h"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+
+namespace {
+
+// 改写前的实现：istringstream + getline + stoi/stol，金额经std::string解析
+Money legacyAmount(const std::string& text) {
+    Money amount = 0;
+    if (MoneyUtil::parse(text, amount)) {
+        return amount;
+    }
+    return MoneyUtil::fromDouble(std::strtod(text.c_str(), nullptr));
+}
+
+std::string legacySerializeTransaction(const TransactionRecord& tx) {
+    std::ostringstream ss;
+    ss << tx.id << "|"
+       << static_cast<int>(tx.type) << "|"
+       << tx.username << "|"
+       << tx.counterparty << "|"
+       << MoneyUtil::format(tx.amount) << "|"
+       << MoneyUtil::format(tx.balance_after) << "|"
+       << tx.description << "|"
+       << tx.timestamp;
+    return ss.str();
+}
+
+TransactionRecord legacyDeserializeTransaction(const std::string& data) {
+    TransactionRecord tx;
+    std::istringstream ss(data);
+
+    std::getline(ss, tx.id, '|');
+
+    std::string typeStr;
+    std::getline(ss, typeStr, '|');
+    tx.type = static_cast<TransactionType>(std::stoi(typeStr));
+
+    std::getline(ss, tx.username, '|');
+    std::getline(ss, tx.counterparty, '|');
+
+    std::string amountStr;
+    std::getline(ss, amountStr, '|');
+    tx.amount = legacyAmount(amountStr);
+
+    std::string balanceStr;
+    std::getline(ss, balanceStr, '|');
+    tx.balance_after = legacyAmount(balanceStr);
+
+    std::getline(ss, tx.description, '|');
+
+    std::string timestampStr;
+    std::getline(ss, timestampStr, '|');
+    tx.timestamp = std::stol(timestampStr);
+
+    return tx;
+}
+
+std::string legacySerializeDeposit(const Deposit& deposit) {
+    std::ostringstream ss;
+    ss << deposit.id << "|"
+       << deposit.username << "|"
+       << MoneyUtil::format(deposit.amount) << "|"
+       << static_cast<int>(deposit.type) << "|"
+       << static_cast<int>(deposit.term) << "|"
+       << deposit.depositTime << "|"
+       << (deposit.isMatured ? "1" : "0");
+    return ss.str();
+}
+
+Deposit legacyDeserializeDeposit(const std::string& data) {
+    Deposit deposit;
+    std::istringstream ss(data);
+
+    std::getline(ss, deposit.id, '|');
+    std::getline(ss, deposit.username, '|');
+
+    std::string amountStr;
+    std::getline(ss, amountStr, '|');
+    deposit.amount = legacyAmount(amountStr);
+
+    std::string typeStr;
+    std::getline(ss, typeStr, '|');
+    deposit.type = static_cast<DepositType>(std::stoi(typeStr));
+
+    std::string termStr;
+    std::getline(ss, termStr, '|');
+    deposit.term = static_cast<TimeDepositTerm>(std::stoi(termStr));
+
+    std::string timeStr;
+    std::getline(ss, timeStr, '|');
+    deposit.depositTime = std::stol(timeStr);
+
+    std::string maturedStr;
+    std::getline(ss, maturedStr, '|');
+    deposit.isMatured = (maturedStr == "1");
+
+    return deposit;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* label, uint64_t records, double seconds, uint64_t checksum) {
+    std::cout << label << ": " << static_cast<uint64_t>(records / seconds) << " records/sec, "
+              << static_cast<uint64_t>(seconds * 1e9 / records) << " ns/record (checksum " << checksum << ")"
+              << std::endl;
+}
+
+} // namespace
+
+// 用法: serializer_bench [记录数] [轮数] [批量解码的历史记录数]
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::strtoul(argv[1], nullptr, 10)) : 10000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 100;
+    size_t historySize = argc > 3 ? static_cast<size_t>(std::strtoul(argv[3], nullptr, 10)) : 1000000;
+    if (count == 0 || rounds <= 0 || historySize == 0) {
+        return 1;
+    }
+
+    // 与线上交易历史相似的记录
+    std::vector<TransactionRecord> transactions(count);
+    std::vector<Deposit> deposits(count);
+    for (size_t i = 0; i < count; i++) {
+        char id[32];
+        snprintf(id, sizeof(id), "TX-%016zX", i);
+        TransactionRecord& tx = transactions[i];
+        tx.id = id;
+        tx.type = static_cast<TransactionType>(1 + i % 4);
+        tx.username = "user" + std::to_string(i % 1000);
+        tx.counterparty = i % 4 >= 2 ? "user" + std::to_string((i + 7) % 1000) : "";
+        tx.amount = static_cast<Money>(i * 137 % 1000000);
+        tx.balance_after = static_cast<Money>(i * 7919 % 100000000);
+        tx.description = "转账给 " + tx.counterparty;
+        tx.timestamp = 1700000000 + static_cast<time_t>(i);
+
+        Deposit& deposit = deposits[i];
+        deposit.id = tx.username + "-" + std::to_string(i);
+        deposit.username = tx.username;
+        deposit.amount = tx.amount;
+        deposit.type = i % 2 ? TIME_DEPOSIT : DEMAND_DEPOSIT;
+        deposit.term = FIVE_MINUTES;
+        deposit.depositTime = tx.timestamp;
+        deposit.isMatured = i % 3 == 0;
+    }
+
+    std::vector<std::string> encodedTransactions(count);
+    std::vector<std::string> encodedDeposits(count);
+    for (size_t i = 0; i < count; i++) {
+        encodedTransactions[i] = Serializer::serializeTransaction(transactions[i]);
+        encodedDeposits[i] = Serializer::serializeDeposit(deposits[i]);
+        if (encodedTransactions[i] != legacySerializeTransaction(transactions[i]) ||
+            encodedDeposits[i] != legacySerializeDeposit(deposits[i])) {
+            std::cerr << "encoding mismatch at " << i << std::endl;
+            return 1;
+        }
+    }
+
+    uint64_t records = static_cast<uint64_t>(count) * rounds;
+    uint64_t checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            checksum += legacySerializeTransaction(transactions[i]).size();
+        }
+    }
+    report("serialize transaction (stringstream)", records, secondsSince(start), checksum);
+
+    checksum = 0;
+    std::string buffer;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            buffer.clear();
+            Serializer::appendTransaction(transactions[i], buffer);
+            checksum += buffer.size();
+        }
+    }
+    report("serialize transaction (append)", records, secondsSince(start), checksum);
+
+    checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            TransactionRecord tx = legacyDeserializeTransaction(encodedTransactions[i]);
+            checksum += static_cast<uint64_t>(tx.amount + tx.timestamp);
+        }
+    }
+    report("deserialize transaction (stringstream)", records, secondsSince(start), checksum);
+
+    checksum = 0;
+    TransactionRecord tx;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            const std::string& data = encodedTransactions[i];
+            if (!Serializer::deserializeTransaction(data.data(), data.size(), tx)) {
+                std::cerr << "decode failed at " << i << std::endl;
+                return 1;
+            }
+            checksum += static_cast<uint64_t>(tx.amount + tx.timestamp);
+        }
+    }
+    report("deserialize transaction (pointer)", records, secondsSince(start), checksum);
+
+    // 二进制格式：体积与解码速度
+    std::vector<std::string> binaryTransactions(count);
+    uint64_t textBytes = 0;
+    uint64_t binaryBytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        binaryTransactions[i] = Serializer::serializeTransaction(transactions[i], RECORD_FORMAT_BINARY);
+        textBytes += encodedTransactions[i].size();
+        binaryBytes += binaryTransactions[i].size();
+    }
+    std::cout << "transaction size: text " << textBytes / count << " bytes, binary " << binaryBytes / count
+              << " bytes" << std::endl;
+
+    checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            buffer.clear();
+            Serializer::appendTransaction(transactions[i], buffer, RECORD_FORMAT_BINARY);
+            checksum += buffer.size();
+        }
+    }
+    report("serialize transaction (binary)", records, secondsSince(start), checksum);
+
+    checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            const std::string& data = binaryTransactions[i];
+            if (!Serializer::deserializeTransaction(data.data(), data.size(), tx)) {
+                std::cerr << "binary decode failed at " << i << std::endl;
+                return 1;
+            }
+            checksum += static_cast<uint64_t>(tx.amount + tx.timestamp);
+        }
+    }
+    report("deserialize transaction (binary)", records, secondsSince(start), checksum);
+
+    checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            Deposit deposit = legacyDeserializeDeposit(encodedDeposits[i]);
+            checksum += static_cast<uint64_t>(deposit.amount + deposit.depositTime);
+        }
+    }
+    report("deserialize deposit (stringstream)", records, secondsSince(start), checksum);
+
+    checksum = 0;
+    Deposit deposit;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            const std::string& data = encodedDeposits[i];
+            if (!Serializer::deserializeDeposit(data.data(), data.size(), deposit)) {
+                std::cerr << "decode failed at " << i << std::endl;
+                return 1;
+            }
+            checksum += static_cast<uint64_t>(deposit.amount + deposit.depositTime);
+        }
+    }
+    report("deserialize deposit (pointer)", records, secondsSince(start), checksum);
+
+    checksum = 0;
+    std::vector<std::string> binaryDeposits(count);
+    for (size_t i = 0; i < count; i++) {
+        binaryDeposits[i] = Serializer::serializeDeposit(deposits[i], RECORD_FORMAT_BINARY);
+    }
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            const std::string& data = binaryDeposits[i];
+            if (!Serializer::deserializeDeposit(data.data(), data.size(), deposit)) {
+                std::cerr << "binary decode failed at " << i << std::endl;
+                return 1;
+            }
+            checksum += static_cast<uint64_t>(deposit.amount + deposit.depositTime);
+        }
+    }
+    report("deserialize deposit (binary)", records, secondsSince(start), checksum);
+
+    // 一个用户的完整交易历史（LRANGE 0 -1的结果）批量解码，分别使用各个分隔符扫描实现
+    std::vector<std::string> history(historySize);
+    uint64_t historyBytes = 0;
+    for (size_t i = 0; i < historySize; i++) {
+        history[i] = encodedTransactions[i % count];
+        historyBytes += history[i].size();
+    }
+    std::cout << "bulk decode of " << historySize << " records (" << historyBytes / (1024 * 1024) << " MB), default scanner "
+              << Serializer::separatorScanner() << std::endl;
+
+    const char* scanners[] = { "scalar", "sse2", "avx2" };
+    std::vector<TransactionRecord> decoded;
+    std::vector<size_t> failed;
+    for (const char* scanner : scanners) {
+        if (!Serializer::useSeparatorScanner(scanner)) {
+            std::cout << "bulk decode (" << scanner << "): not supported on this CPU" << std::endl;
+            continue;
+        }
+        checksum = 0;
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < 3; r++) {
+            // 保留上一轮的元素，复用其字符串容量（与服务端逐次请求分配新数组的差别只在首轮）
+            failed.clear();
+            if (Serializer::deserializeTransactions(history, decoded, failed) != historySize) {
+                std::cerr << "bulk decode failed at " << failed.front() << std::endl;
+                return 1;
+            }
+            checksum += static_cast<uint64_t>(decoded.back().amount + decoded.back().timestamp);
+        }
+        double seconds = secondsSince(start);
+        std::string label = std::string("bulk decode (") + scanner + ")";
+        report(label.c_str(), historySize * 3, seconds, checksum);
+        std::cout << "  " << static_cast<uint64_t>(historyBytes * 3 / seconds / (1024 * 1024)) << " MB/sec" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+// FakeRedisMain.cpp - Stand-alone fake Redis server for tests and load benchmarks
+#include <iostream>
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+#include "FakeRedisServer.h"
+
+const int DEFAULT_PORT = 6379;
+
+FakeRedisServer* globalServer = nullptr;
+
+void signalHandler(int signal) {
+    std::cout << "Received signal " << signal << std::endl;
+    if (globalServer) {
+        globalServer->stop();
+    }
+    exit(0);
+}
+
+void printHelp(const char* programName) {
+    std::cout << "Fake Redis server (RESP subset used by banking_server)\n\n";
+    std::cout << "Usage: " << programName << " [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h, --help              Show this help message and exit\n";
+    std::cout << "  -p, --port <port>       Listen port on 127.0.0.1 (default: " << DEFAULT_PORT << ", 0 = any)\n";
+    std::cout << "  --password <password>   Require AUTH with this password (default: none)\n";
+    std::cout << "  --latency-us <n>        Delay injected before each reply batch (default: 0)\n";
+}
+
+int main(int argc, char* argv[]) {
+    int port = DEFAULT_PORT;
+    std::string password;
+    unsigned latencyUs = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            printHelp(argv[0]);
+            return 0;
+        } else if ((strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--port") == 0) && i + 1 < argc) {
+            port = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--password") == 0 && i + 1 < argc) {
+            password = argv[++i];
+        } else if (strcmp(argv[i], "--latency-us") == 0 && i + 1 < argc) {
+            latencyUs = std::stoul(argv[++i]);
+        } else {
+            std::cerr << "Error: Unknown or incomplete option '" << argv[i] << "'\n";
+            printHelp(argv[0]);
+            return 1;
+        }
+    }
+
+    FakeRedisServer server(port, password, latencyUs);
+    if (!server.start()) {
+        return 1;
+    }
+    globalServer = &server;
+
+    std::signal(SIGINT, signalHandler);
+    std::signal(SIGTERM, signalHandler);
+
+    while (true) {
+        pause();
+    }
+    return 0;
+}